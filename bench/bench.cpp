@@ -0,0 +1,88 @@
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <new>
+#include <fmt/format.h>
+#include "bench.h"
+#include "logging.hpp"
+#include "wpSQLDatabase.h"
+
+namespace fs = std::filesystem;
+
+static std::map<std::string, Bench::Scenario> &Scenarios() {
+    static std::map<std::string, Bench::Scenario> list;
+    return list;
+}
+
+bool Bench::Register(const std::string &name, Scenario fn) {
+    Scenarios()[name] = std::move(fn);
+    return true;
+}
+
+void Bench::State::Report(const std::string &name, double value, const std::string &unit) {
+    results.push_back({scenario, name, value, unit});
+    std::cout << fmt::format("  {:<48} {:>16.2f} {}", name, value, unit) << std::endl;
+}
+
+int64_t Bench::Param(const std::string &name, int64_t defaultValue) {
+    auto v = std::getenv(fmt::format("WPSQL_BENCH_{}", name).c_str());
+    return v ? std::atoll(v) : defaultValue;
+}
+
+std::string Bench::WorkPath(const std::string &fileName) {
+    fs::path folder = fs::current_path() / "bench_work";
+    fs::create_directories(folder);
+    auto path = (folder / fileName).string();
+    for (auto suffix : {"", "-wal", "-shm", "-journal"}) fs::remove(path + suffix);
+    return path;
+}
+
+// wpsql_bench counts its own allocations; a thread_local keeps the counting free of locked increments
+static thread_local int64_t allocations = 0;
+
+void *operator new(size_t n) {
+    allocations++;
+    if (auto p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+int64_t Bench::Allocations() { return allocations; }
+
+// usage: wpsql_bench [--list] [--json=results.json] [--label=<commit>] [filter...]   (a scenario runs when its name contains any filter)
+int main(int argc, char **argv) {
+    DB::Logger::initialize("wpsql_bench", "warn");
+    std::vector<std::string> filters;
+    std::string jsonFile, label;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            for (auto &[name, fn] : Scenarios()) std::cout << name << std::endl;
+            return 0;
+        } else if (arg.starts_with("--json="))
+            jsonFile = arg.substr(7);
+        else if (arg.starts_with("--label="))
+            label = arg.substr(8);
+        else
+            filters.push_back(arg);
+    }
+    std::vector<Bench::Result> results;
+    for (auto &[name, fn] : Scenarios()) {
+        bool selected = filters.empty();
+        for (auto &f : filters) selected = selected || name.find(f) != std::string::npos;
+        if (!selected) continue;
+        std::cout << name << std::endl;
+        try {
+            Bench::State state(name, results);
+            fn(state);
+        } catch (wpSQLException &e) {
+            std::cout << "  failed: " << e.message << std::endl;
+        } catch (std::exception &e) {
+            std::cout << "  failed: " << e.what() << std::endl;
+        }
+    }
+    if (!jsonFile.empty()) WriteJson(jsonFile, label, results);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal self-contained benchmark harness for wpSQL.
+ *
+ * Scenarios register themselves with BENCH_SCENARIO and report their numbers
+ * through Bench::State. Sizes can be overridden from the environment, eg.
+ * WPSQL_BENCH_ROWS=1000000, so the same binary serves quick and long runs.
+ */
+namespace Bench {
+    struct Result {
+        std::string scenario;
+        std::string name;
+        double value;
+        std::string unit;
+    };
+
+    class State {
+        std::string scenario;
+        std::vector<Result> &results;
+
+    public:
+        State(const std::string &s, std::vector<Result> &r) : scenario(s), results(r) {}
+        const std::string &GetScenario() const { return scenario; }
+        void Report(const std::string &name, double value, const std::string &unit);
+
+        // runs fn(i) for i in [0, iterations); reports ns/op and ops/s, returns elapsed seconds
+        template<typename Fn> double Measure(const std::string &name, int64_t iterations, Fn &&fn) {
+            auto start = std::chrono::steady_clock::now();
+            for (int64_t i = 0; i < iterations; i++) fn(i);
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            Report(name + ".ns_per_op", iterations > 0 ? sec * 1e9 / iterations : 0, "ns");
+            Report(name + ".ops_per_sec", sec > 0 ? iterations / sec : 0, "ops/s");
+            return sec;
+        }
+    };
+
+    using Scenario = std::function<void(State &)>;
+
+    bool Register(const std::string &name, Scenario fn);
+    int64_t Param(const std::string &name, int64_t defaultValue);  // WPSQL_BENCH_<name> overrides defaultValue
+    std::string WorkPath(const std::string &fileName);              // removes any previous file of that name
+    int64_t Allocations();                                          // operator new calls made by the calling thread so far
+
+    // bench_json.cpp, shared with wpsql_contention
+    std::string JsonString(const std::string &s);
+    // {"label", "timestamp", <extraFields>, "results": [...]}; extraFields is a preformatted "key": value list or empty
+    void WriteJson(const std::string &fileName, const std::string &label, const std::vector<Result> &results, const std::string &extraFields = "");
+
+    template<typename T> inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static const volatile void *sink;
+        sink = &value;
+#endif
+    }
+}  // namespace Bench
+
+#define BENCH_SCENARIO(name, fn) static bool bench_registered_##fn = Bench::Register(name, fn)
@@ -0,0 +1,87 @@
+#include "bench.h"
+#include "asyncDatabase.h"
+
+namespace {
+    // one caller: n point queries one after another, each awaited
+    DB::AsyncTask<double> Lookups(DB::AsyncDatabase &db, int64_t first, int64_t n, int64_t nRows) {
+        double sum = 0;
+        for (int64_t i = 0; i < n; i++) {
+            auto rows = co_await db.QueryAsync("select amount from t where id = ?", (first + i) * 7919 % nRows);
+            if (rows.RowCount() > 0) sum += rows.Get<double>(0, 0);
+        }
+        co_return sum;
+    }
+
+    DB::AsyncTask<int64_t> Cancelled(DB::AsyncDatabase &db, const DB::AsyncCancel &cancel) {
+        try {
+            co_return co_await db.RunAsync([](wpSQLDatabase &conn) { return conn.ExecuteScalar<int64_t>("with recursive c(x) as (select 1 union all select x + 1 from c) select count(*) from c"); }, cancel);
+        } catch (wpSQLException &e) {
+            co_return -e.rc;
+        }
+    }
+}
+
+// Point queries run on the caller's thread against co_await'ed from coroutines on a run loop, with 1 and 4
+// worker connections; then how long a runaway query takes to stop once cancelled.
+static void BenchAsyncQuery(Bench::State &state) {
+    const int64_t n = Bench::Param("ASYNC_QUERIES", 100000);
+    const int64_t nRows = 10000;
+    const int64_t callers = Bench::Param("ASYNC_CALLERS", 64);
+    auto fileName = Bench::WorkPath("async.db");
+    {
+        wpSQLDatabase db;
+        db.Open(fileName);
+        db.ExecuteUpdate("pragma journal_mode=wal");
+        db.ExecuteUpdate("create table t(id integer primary key, amount real)");
+        db.Begin();
+        auto insert = db.PrepareStatement("insert into t(id, amount) values(?, ?)");
+        for (int64_t i = 0; i < nRows; i++) {
+            insert->Bind(1, i);
+            insert->Bind(2, i * 0.5);
+            insert->ExecuteUpdate();
+        }
+        db.Commit();
+    }
+
+    double sum = 0;
+    {
+        wpSQLDatabase db;
+        db.Open(fileName);
+        db.EnableStatementCache();
+        state.Measure("sync", n, [&](int64_t i) {
+            auto stmt = db.PrepareStatement("select amount from t where id = ?");
+            stmt->Bind(1, i * 7919 % nRows);
+            auto rs = stmt->Query();
+            if (rs.NextRow()) sum += rs.Get<double>(0);
+        });
+    }
+    {
+        DB::AsyncDatabase db(fileName);
+        state.Measure("wait", n, [&](int64_t i) { sum += db.QueryAsync("select amount from t where id = ?", i * 7919 % nRows).Wait().Get<double>(0, 0); });
+    }
+    for (int connections : {1, 4}) {
+        DB::AsyncRunLoop loop;
+        DB::AsyncDatabase db(fileName, {.connections = connections, .post = loop.Poster()});
+        std::vector<DB::AsyncTask<double>> tasks;
+        state.Measure(fmt::format("co_await.{}_connections", connections), n, [&](int64_t i) {
+            if (i > 0) return;
+            for (int64_t c = 0; c < callers; c++) tasks.push_back(Lookups(db, c * (n / callers), n / callers, nRows));
+            loop.RunUntil([&] { return std::all_of(tasks.begin(), tasks.end(), [](auto &t) { return t.IsDone(); }); });
+        });
+        for (auto &task : tasks) sum += task.await_resume();
+    }
+    Bench::DoNotOptimize(sum);
+
+    DB::AsyncRunLoop loop;
+    DB::AsyncDatabase db(fileName, {.post = loop.Poster()});
+    DB::AsyncCancel cancel;
+    auto task = Cancelled(db, cancel);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto start = std::chrono::steady_clock::now();
+    cancel.Cancel();
+    int64_t rc = -loop.Run(task);
+    state.Report("cancel.latency", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), "ms");
+    state.Report("cancel.interrupted", rc == SQLITE_INTERRUPT, "bool");
+}
+
+BENCH_SCENARIO("async.query", BenchAsyncQuery);
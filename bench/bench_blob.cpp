@@ -0,0 +1,83 @@
+#include <filesystem>
+#include <fstream>
+#include "bench.h"
+#include "ZIP.h"
+#include "wpSQLBlob.h"
+
+// A large blob written and read whole (Bind / GetBlob) against streamed through wpSQLBlob, then copied into and out of a zip entry.
+static void BenchBlobStream(Bench::State &state) {
+    const int64_t nBytes = Bench::Param("BLOB_MB", 16) * 1024 * 1024;
+    auto source = Bench::WorkPath("blob_source.bin");
+    {
+        std::ofstream out(source, std::ios::binary);
+        std::vector<char> chunk(wpSQLBlob::defaultChunkSize);
+        for (size_t i = 0; i < chunk.size(); i++) chunk[i] = char(i * 31 + i / 7);
+        for (int64_t written = 0; written < nBytes; written += chunk.size()) out.write(chunk.data(), std::min<int64_t>(chunk.size(), nBytes - written));
+    }
+    wpSQLDatabase db;
+    db.Open(Bench::WorkPath("blob.db"));
+    db.ExecuteUpdate("create table receipts(id integer primary key, image blob)");
+    auto insert = db.PrepareStatement("insert into receipts(id, image) values(?, ?)");
+    const double mb = nBytes / (1024.0 * 1024.0);
+
+    // sqlite's own peak heap while fn runs; the whole-blob paths also hold a full copy on the application side
+    auto timed = [&](const std::string &name, auto &&fn) {
+        sqlite3_memory_highwater(1);
+        int64_t base = sqlite3_memory_used();
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        state.Report(name + ".mb_per_sec", mb / sec, "MB/s");
+        state.Report(name + ".sqlite_peak", (sqlite3_memory_highwater(0) - base) / (1024.0 * 1024.0), "MB");
+    };
+
+    timed("whole.write", [&] {
+        std::ifstream in(source, std::ios::binary);
+        std::vector<unsigned char> data(nBytes);
+        in.read(reinterpret_cast<char *>(data.data()), nBytes);
+        insert->Bind(1, int64_t(1));
+        insert->Bind(2, data.data(), static_cast<int>(nBytes));
+        insert->ExecuteUpdate();
+    });
+    timed("stream.write", [&] {
+        std::ifstream in(source, std::ios::binary);
+        insert->Bind(1, int64_t(2));
+        insert->BindZeroBlob(2, nBytes);
+        insert->ExecuteUpdate();
+        db.OpenBlob("receipts", "image", 2, true)->CopyFrom(in);
+    });
+    auto wholeCopy = Bench::WorkPath("blob_whole.bin"), streamCopy = Bench::WorkPath("blob_stream.bin");
+    timed("whole.read", [&] {
+        std::ofstream out(wholeCopy, std::ios::binary);
+        auto rs = db.ExecuteQuery("select image from receipts where id = 1");
+        int64_t len = 0;
+        if (rs->NextRow()) {
+            auto data = rs->GetBlob(0, len);
+            out.write(reinterpret_cast<const char *>(data), len);
+        }
+    });
+    timed("stream.read", [&] {
+        std::ofstream out(streamCopy, std::ios::binary);
+        db.OpenBlob("receipts", "image", 2)->CopyTo(out);
+    });
+
+    state.Report("copies_equal_size", std::filesystem::file_size(wholeCopy) == uint64_t(nBytes) && std::filesystem::file_size(streamCopy) == uint64_t(nBytes), "bool");
+
+    auto zipName = Bench::WorkPath("blob.zip");
+    timed("stream.to_zip", [&] {
+        Partio::ZipFileWriter zip(zipName);
+        std::unique_ptr<std::ostream> entry(zip.Add_File("receipt.bin"));
+        db.OpenBlob("receipts", "image", 2)->CopyTo(*entry);
+    });
+    timed("stream.from_zip", [&] {
+        Partio::ZipFileReader zip(zipName);
+        std::unique_ptr<std::istream> entry(zip.Get_File("receipt.bin"));
+        insert->Bind(1, int64_t(3));
+        insert->BindZeroBlob(2, nBytes);
+        insert->ExecuteUpdate();
+        db.OpenBlob("receipts", "image", 3, true)->CopyFrom(*entry);
+    });
+    state.Report("round_trip_equal", db.ExecuteScalar("select count(*) from receipts a, receipts b where a.id = 1 and b.id = 3 and a.image = b.image"), "bool");
+}
+
+BENCH_SCENARIO("blob.stream", BenchBlobStream);
@@ -0,0 +1,236 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include "bench.h"
+#include "member_db.h"
+#include "ZIP.h"
+#include "ulid.hpp"
+
+/*
+ * Hot paths of the library on the sample member schema. Each scenario builds
+ * its own database under bench_work/ so they can be run one at a time.
+ * ULID generation and hashing are covered by the ulid.* scenarios.
+ */
+
+namespace {
+    class HotDb : public MemberDb {
+    public:
+        explicit HotDb(const std::string &fileName) { SetDBName(fileName); }
+    };
+
+    class HotTransactionDb : public TransactionDB {
+    public:
+        HotTransactionDb(const std::string &fileName, DB::SQLiteBase *master) : TransactionDB(fileName, master) {}
+    };
+
+    const char *firstNames[] = {"Ahmad", "Siti", "Tan", "Lim", "Kumar", "Nur", "Wong", "Aisyah", "Raj", "Mei"};
+    const char *lastNames[] = {"Abdullah", "Ibrahim", "Wei Ming", "Chee Keong", "Subramaniam", "Hidayah", "Kah Wai", "Rahman", "Pillai", "Ling"};
+
+    struct Fixture {
+        std::unique_ptr<HotDb> db;
+        std::vector<ULID> memberIds;
+        std::mt19937_64 rng {42};
+
+        // members, their transactions and the FTS index; nTrans == 0 skips the transactions
+        Fixture(const std::string &fileName, int64_t nMembers, int64_t nTrans) {
+            db = std::make_unique<HotDb>(Bench::WorkPath(fileName));
+            db->Open(true);
+            auto &session = db->GetSession();
+            auto insertMember = session.PrepareStatement("insert into members(id, dob, noOfTrans, timeCreated) values(?,?,?,?)");
+            auto insertFTS = session.PrepareStatement("insert into MemberFTS(rowid, name, IC, telNo, email) values(?,?,?,?,?)");
+            auto insertTrans = session.PrepareStatement("insert into memberTransactions(id, amount, timeCreated) values(?,?,?)");
+            memberIds.reserve(nMembers);
+            session.Begin();
+            for (int64_t i = 0; i < nMembers; i++) {
+                memberIds.emplace_back();
+                insertMember->Bind(1, memberIds.back());
+                insertMember->Bind(2, static_cast<int64_t>(rng() % 30000));
+                insertMember->Bind(3, static_cast<int64_t>(nTrans / std::max<int64_t>(nMembers, 1)));
+                insertMember->Bind(4, static_cast<int64_t>(memberIds.back().timestamp()));
+                insertMember->ExecuteUpdate();
+                insertFTS->Bind(1, i + 1);
+                insertFTS->Bind(2, fmt::format("{} {}", firstNames[rng() % 10], lastNames[rng() % 10]));
+                insertFTS->Bind(3, fmt::format("{:06}-{:02}-{:04}", rng() % 1000000, rng() % 15, rng() % 10000));
+                insertFTS->Bind(4, fmt::format("01{}-{:07}", rng() % 10, rng() % 10000000));
+                insertFTS->Bind(5, fmt::format("member{}@example.com", i));
+                insertFTS->ExecuteUpdate();
+            }
+            for (int64_t i = 0; i < nTrans; i++) {
+                ULID id;
+                insertTrans->Bind(1, id);
+                insertTrans->Bind(2, static_cast<int64_t>(rng() % 100000));
+                insertTrans->Bind(3, static_cast<int64_t>(id.timestamp()));
+                insertTrans->ExecuteUpdate();
+            }
+            session.Commit();
+        }
+
+        const ULID &AnyMember() { return memberIds[rng() % memberIds.size()]; }
+    };
+}  // namespace
+
+// Point lookup by primary key: prepared once, prepared per call, and through ExecuteScalar with the key inlined.
+static void BenchPointLookup(Bench::State &state) {
+    const int64_t nReads = Bench::Param("READS", 100000);
+    Fixture f("hot_lookup.db", Bench::Param("MEMBERS", 50000), 0);
+    auto &session = f.db->GetSession();
+
+    auto select = session.PrepareStatement("select dob, timeCreated from members where id=?");
+    state.Measure("prepared_once", nReads, [&](int64_t) {
+        select->Bind(1, f.AnyMember());
+        auto rs = select->ExecuteQuery();
+        if (rs->NextRow()) Bench::DoNotOptimize(rs->Get<int64_t>(0));
+    });
+    select.reset();
+    state.Measure("prepare_per_call", nReads, [&](int64_t) {
+        auto stt = session.PrepareStatement("select dob, timeCreated from members where id=?");
+        stt->Bind(1, f.AnyMember());
+        auto rs = stt->ExecuteQuery();
+        if (rs->NextRow()) Bench::DoNotOptimize(rs->Get<int64_t>(0));
+    });
+    state.Measure("execute_scalar", nReads, [&](int64_t) {
+        Bench::DoNotOptimize(session.ExecuteScalar(fmt::format("select dob from members where id=x'{}'", f.AnyMember().toHex())));
+    });
+}
+
+BENCH_SCENARIO("hot.point_lookup", BenchPointLookup);
+
+// Full scans through Execute(sql, fn) (sqlite3_exec with char ** rows) against a wpSQLResultSet loop.
+static void BenchScan(Bench::State &state) {
+    const int64_t nTrans = Bench::Param("TRANSACTIONS", 300000);
+    Fixture f("hot_scan.db", 1000, nTrans);
+    auto &session = f.db->GetSession();
+    int64_t total = 0;
+    double sec = state.Measure("execute_callback", 5, [&](int64_t) {
+        session.Execute("select id, amount, timeCreated from memberTransactions", [&total](int, char **val, char **) { total += std::atoll(val[1]); });
+    });
+    state.Report("execute_callback.rows_per_sec", 5 * nTrans / sec, "rows/s");
+    sec = state.Measure("resultset", 5, [&](int64_t) {
+        auto rs = session.ExecuteQuery("select id, amount, timeCreated from memberTransactions");
+        while (rs->NextRow()) total += rs->Get<int64_t>(1);
+    });
+    state.Report("resultset.rows_per_sec", 5 * nTrans / sec, "rows/s");
+    Bench::DoNotOptimize(total);
+}
+
+BENCH_SCENARIO("hot.scan", BenchScan);
+
+// UserDBRegistry::GetKey for keys that exist, and SetKey updates.
+static void BenchRegistryKeys(Bench::State &state) {
+    const int64_t nKeys = Bench::Param("KEYS", 1000);
+    const int64_t nReads = Bench::Param("READS", 50000);
+    Fixture f("hot_registry.db", 1, 0);
+    auto registry = f.db->GetRegistry();
+    {
+        auto committer = f.db->GetSession().GetAutoCommitter();
+        for (int64_t i = 0; i < nKeys; i++) registry->SetKey(fmt::format("config.key.{}", i), fmt::format("value-{}", i));
+        committer->SetOK();
+    }
+    state.Measure("get_key", nReads, [&](int64_t i) { Bench::DoNotOptimize(registry->GetKey(fmt::format("config.key.{}", i % nKeys))); });
+    state.Measure("get_key_int", nReads, [&](int64_t i) { Bench::DoNotOptimize(registry->GetKey<int64_t>("counter.missing", 7)); });
+    state.Measure("set_key", nReads / 10, [&](int64_t i) { registry->SetKey(fmt::format("config.key.{}", i % nKeys), fmt::format("updated-{}", i)); });
+}
+
+BENCH_SCENARIO("hot.registry_keys", BenchRegistryKeys);
+
+// Bulk insert in one transaction: memberTransactions rows keyed by ulid, then MemberFTS rows.
+static void BenchBulkInsert(Bench::State &state) {
+    const int64_t nRows = Bench::Param("ROWS", 200000);
+    HotDb db(Bench::WorkPath("hot_bulk.db"));
+    db.Open(true);
+    auto &session = db.GetSession();
+    std::mt19937_64 rng(7);
+    auto insert = session.PrepareStatement("insert into memberTransactions(id, amount, timeCreated) values(?,?,?)");
+    session.Begin();
+    double sec = state.Measure("transactions", nRows, [&](int64_t) {
+        ULID id;
+        insert->Bind(1, id);
+        insert->Bind(2, static_cast<int64_t>(rng() % 100000));
+        insert->Bind(3, static_cast<int64_t>(id.timestamp()));
+        insert->ExecuteUpdate();
+    });
+    auto start = std::chrono::steady_clock::now();
+    session.Commit();
+    state.Report("commit", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), "ms");
+    state.Report("rows_per_sec_with_commit", nRows / (sec + std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()), "rows/s");
+
+    auto insertFTS = session.PrepareStatement("insert into MemberFTS(name, IC, telNo, email) values(?,?,?,?)");
+    session.Begin();
+    state.Measure("fts_rows", nRows / 4, [&](int64_t i) {
+        insertFTS->Bind(1, fmt::format("{} {}", firstNames[rng() % 10], lastNames[rng() % 10]));
+        insertFTS->Bind(2, fmt::format("{:06}-{:02}-{:04}", rng() % 1000000, rng() % 15, rng() % 10000));
+        insertFTS->Bind(3, fmt::format("01{}-{:07}", rng() % 10, rng() % 10000000));
+        insertFTS->Bind(4, fmt::format("member{}@example.com", i));
+        insertFTS->ExecuteUpdate();
+    });
+    session.Commit();
+}
+
+BENCH_SCENARIO("hot.bulk_insert", BenchBulkInsert);
+
+// TransactionDB::Migrate copying memberTransactions out of the master, and RestructureTable rebuilding it in place.
+static void BenchMigrateRestructure(Bench::State &state) {
+    const int64_t nTrans = Bench::Param("TRANSACTIONS", 200000);
+    Fixture f("hot_migrate_master.db", 1000, nTrans);
+    {
+        HotTransactionDb trans(Bench::WorkPath("hot_migrate_trans.db"), f.db.get());
+        trans.Open(true);
+        std::vector<std::string> tables {"MemberTransactions"};
+        double sec = state.Measure("migrate", 1, [&](int64_t) { trans.Migrate(f.db.get(), tables); });
+        state.Report("migrate.rows_per_sec", nTrans / sec, "rows/s");
+    }
+    double sec = state.Measure("restructure_table", 1, [&](int64_t) { f.db->RestructureTable("MemberTransactions"); });
+    state.Report("restructure_table.rows_per_sec", nTrans / sec, "rows/s");
+}
+
+BENCH_SCENARIO("hot.migrate_restructure", BenchMigrateRestructure);
+
+// Online backup with BackupTo followed by zipping the copy, the two halves of SQLiteBase::BackupDB without its throttling.
+static void BenchBackupZip(Bench::State &state) {
+    Fixture f("hot_backup.db", Bench::Param("MEMBERS", 20000), Bench::Param("TRANSACTIONS", 200000));
+    auto copy = Bench::WorkPath("hot_backup_copy.db");
+    auto zipName = Bench::WorkPath("hot_backup.zip");
+    f.db->GetSession().ExecuteUpdate("pragma wal_checkpoint(truncate)");
+    auto bytes = std::filesystem::file_size(f.db->GetDBName());
+    state.Report("database_size", bytes / 1048576.0, "MB");
+
+    double sec = state.Measure("backup_to", 1, [&](int64_t) { f.db->GetSession().BackupTo(copy, nullptr, nullptr, 1000, 0); });
+    state.Report("backup_to.mb_per_sec", bytes / 1048576.0 / sec, "MB/s");
+    sec = state.Measure("zip", 1, [&](int64_t) {
+        Partio::ZipFileWriter zip(zipName);
+        std::unique_ptr<std::ostream> o(zip.Add_File("hot_backup_copy.db"));
+        std::ifstream in(copy, std::ios::in | std::ios::binary);
+        std::string buf(1 << 16, '\0');
+        while (in) {
+            in.read(&buf[0], buf.size());
+            o->write(buf.data(), in.gcount());
+        }
+        o->flush();
+    });
+    state.Report("zip.mb_per_sec", bytes / 1048576.0 / sec, "MB/s");
+    state.Report("zip.ratio", double(bytes) / std::filesystem::file_size(zipName), "x");
+}
+
+BENCH_SCENARIO("hot.backup_zip", BenchBackupZip);
+
+// FTS5 prefix search on MemberFTS with the query built by BuildFTSSearch.
+static void BenchFTSSearch(Bench::State &state) {
+    const int64_t nSearches = Bench::Param("SEARCHES", 20000);
+    Fixture f("hot_fts.db", Bench::Param("MEMBERS", 100000), 0);
+    auto &session = f.db->GetSession();
+    auto search = session.PrepareStatement("select rowid, name, telNo from MemberFTS where MemberFTS match ? order by rank limit 20");
+    int64_t hits = 0;
+    state.Measure("name_prefix", nSearches, [&](int64_t i) {
+        search->Bind(1, BuildFTSSearch(fmt::format("{} {}", std::string(firstNames[i % 10]).substr(0, 3), std::string(lastNames[(i / 10) % 10]).substr(0, 2))));
+        auto rs = search->ExecuteQuery();
+        while (rs->NextRow()) hits++;
+    });
+    state.Measure("email_exact", nSearches, [&](int64_t i) {
+        search->Bind(1, fmt::format("email:\"member{}\"", i % 100000));
+        auto rs = search->ExecuteQuery();
+        while (rs->NextRow()) hits++;
+    });
+    state.Report("rows_returned", double(hits), "rows");
+}
+
+BENCH_SCENARIO("hot.fts_search", BenchFTSSearch);
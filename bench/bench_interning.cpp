@@ -0,0 +1,55 @@
+#include <string_view>
+#include <vector>
+#include "bench.h"
+#include "wpSQLDatabase.h"
+
+// Report-style scan of low-cardinality text columns, kept per row: Get<std::string> copies against Get<std::string_view> interning.
+static void BenchInterning(Bench::State &state) {
+    const int64_t n = Bench::Param("INTERN_ROWS", 1000000);
+    wpSQLDatabase db;
+    db.Open(":memory:");
+    db.ExecuteUpdate("create table lines(id integer primary key, typeName text, code text, status text)");
+    const char *types[] = {"Cash Sale Invoice", "Credit Sale Invoice", "Purchase Order Receipt", "Stock Adjustment Note", "Customer Return Note"};
+    const char *statuses[] = {"Pending approval", "Approved and posted", "Cancelled by user"};
+    db.Begin();
+    auto insert = db.PrepareStatement("insert into lines(id, typeName, code, status) values(?, ?, ?, ?)");
+    for (int64_t i = 0; i < n; i++) {
+        insert->Bind(1, i);
+        insert->Bind(2, std::string(types[i % 5]));
+        insert->Bind(3, fmt::format("BRANCH-OUTLET-{:03}", i % 40));
+        insert->Bind(4, std::string(statuses[i % 3]));
+        insert->ExecuteUpdate();
+    }
+    db.Commit();
+
+    auto scan = [&](auto get) {
+        using Value = decltype(get(std::declval<wpSQLResultSet &>(), 0));
+        std::vector<Value> kept;
+        kept.reserve(n * 3);
+        int64_t before = Bench::Allocations();
+        auto start = std::chrono::steady_clock::now();
+        auto rs = db.Execute("select typeName, code, status from lines");
+        while (rs->NextRow()) {
+            for (int c = 0; c < 3; c++) kept.push_back(get(*rs, c));
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        int64_t allocated = Bench::Allocations() - before;
+        size_t heapBytes = 0;
+        for (auto &v : kept) {
+            if constexpr (std::is_same_v<Value, std::string>) heapBytes += v.capacity() > 15 ? v.capacity() + 1 : 0;  // libstdc++ keeps up to 15 chars inline
+        }
+        if (auto arena = rs->GetStringArena()) heapBytes += arena->Bytes();
+        return std::tuple(ns / n, double(allocated) / n, double(heapBytes));
+    };
+
+    auto [copyNs, copyAllocs, copyBytes] = scan([](wpSQLResultSet &rs, int c) { return rs.Get<std::string>(c); });
+    auto [internNs, internAllocs, internBytes] = scan([](wpSQLResultSet &rs, int c) { return rs.Get<std::string_view>(c); });
+    state.Report("string.ns_per_row", copyNs, "ns");
+    state.Report("string.allocs_per_row", copyAllocs, "allocs");
+    state.Report("string.text_bytes", copyBytes / (1024.0 * 1024.0), "MB");
+    state.Report("interned.ns_per_row", internNs, "ns");
+    state.Report("interned.allocs_per_row", internAllocs, "allocs");
+    state.Report("interned.text_bytes", internBytes / (1024.0 * 1024.0), "MB");
+}
+
+BENCH_SCENARIO("resultset.interning", BenchInterning);
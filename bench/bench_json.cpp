@@ -0,0 +1,35 @@
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <fmt/format.h>
+#include "bench.h"
+
+std::string Bench::JsonString(const std::string &s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\')
+            out += fmt::format("\\{}", char(c));
+        else if (c < 0x20)
+            out += fmt::format("\\u{:04x}", c);
+        else
+            out.push_back(char(c));
+    }
+    return out + "\"";
+}
+
+// one object per run; results keep the order they were reported in
+void Bench::WriteJson(const std::string &fileName, const std::string &label, const std::vector<Result> &results, const std::string &extraFields) {
+    std::ofstream out(fileName, std::ios::out | std::ios::trunc);
+    char timestamp[32];
+    auto now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    out << "{\n  \"label\": " << JsonString(label) << ",\n  \"timestamp\": " << JsonString(timestamp) << ",\n";
+    if (!extraFields.empty()) out << "  " << extraFields << ",\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        auto &r = results[i];
+        out << (i ? ",\n" : "\n") << fmt::format("    {{\"scenario\": {}, \"name\": {}, \"value\": {}, \"unit\": {}}}", JsonString(r.scenario), JsonString(r.name), r.value, JsonString(r.unit));
+    }
+    out << "\n  ]\n}\n";
+    if (!out) std::cerr << "cannot write " << fileName << std::endl;
+}
@@ -0,0 +1,95 @@
+#include <spdlog/sinks/rotating_file_sink.h>
+#include "bench.h"
+#include "auditLog.h"
+#include "logging.hpp"
+
+// Caller-side cost of LOG_INFO with a synchronous rotating file sink against the async logger and its overflow policies.
+static void BenchAsyncLogging(Bench::State &state) {
+    const int64_t n = Bench::Param("MESSAGES", 500000);
+    auto fileName = Bench::WorkPath("logging.log");
+    auto logLine = [](int64_t i) { LOG_INFO("migrate table {} row {} of {} copied in {:.3f} ms", "MemberTransactions", i, 1000000, i * 0.001); };
+
+    DB::Logger::shutdown();
+    {
+        // what LOG_INFO does with a synchronous sink: format and write on the calling thread under the sink mutex
+        spdlog::logger logger("bench_sync", std::make_shared<spdlog::sinks::rotating_file_sink_mt>(fileName, 64 * 1024 * 1024, 2));
+        logger.set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [%l] %v");
+        state.Measure("sync_file.log_info", n, [&](int64_t i) { logger.info("migrate table {} row {} of {} copied in {:.3f} ms", "MemberTransactions", i, 1000000, i * 0.001); });
+    }
+
+    struct Mode {
+        std::string label;
+        DB::Logger::OverflowPolicy overflow;
+        size_t queueSize;
+    };
+    for (auto &mode : {Mode {"async_block", DB::Logger::OverflowPolicy::Block, 8192}, Mode {"async_drop_oldest", DB::Logger::OverflowPolicy::DropOldest, 1024},
+                       Mode {"async_drop_newest", DB::Logger::OverflowPolicy::DropNewest, 1024}}) {
+        DB::Logger::AsyncOptions options;
+        options.console = false;
+        options.fileName = Bench::WorkPath(mode.label + ".log");
+        options.maxFileSize = 64 * 1024 * 1024;
+        options.overflow = mode.overflow;
+        options.queueSize = mode.queueSize;
+        DB::Logger::initializeAsync("bench_" + mode.label, "info", options);
+        state.Measure(mode.label + ".log_info", n, logLine);
+        auto start = std::chrono::steady_clock::now();
+        while (DB::Logger::queuedMessages() > 0) std::this_thread::yield();
+        state.Report(mode.label + ".drain", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), "ms");
+        state.Report(mode.label + ".dropped", double(DB::Logger::droppedMessages()), "msgs");
+        DB::Logger::shutdown();
+    }
+    DB::Logger::initialize("wpsql_bench", "warn");
+}
+
+BENCH_SCENARIO("logging.async", BenchAsyncLogging);
+
+namespace {
+    // the function LOG_DEBUG was before: std::string format, runtime parsing, arguments always evaluated
+    template<typename... Args> void LegacyLogDebug(const std::string &format, Args &&...args) {
+        if (auto logger = DB::Logger::get()) logger->debug(fmt::runtime(format), std::forward<Args>(args)...);
+    }
+
+    std::string Describe(int64_t i) { return fmt::format("row-{}", i); }  // an argument that costs something to build
+}  // namespace
+
+// Cost of a LOG_DEBUG call in a tight loop while the debug level is disabled.
+static void BenchDisabledDebugLog(Bench::State &state) {
+    const int64_t n = Bench::Param("LOOPS", 10000000);
+    auto logger = DB::Logger::get();
+    auto level = logger->level();
+    logger->set_level(spdlog::level::info);
+    state.Measure("legacy_function", n, [](int64_t i) { LegacyLogDebug("restructure {} at {}", Describe(i), i); });
+    state.Measure("macro", n, [](int64_t i) { LOG_DEBUG("restructure {} at {}", Describe(i), i); });
+    state.Measure("empty_loop", n, [](int64_t i) { Bench::DoNotOptimize(i); });
+    logger->set_level(level);
+}
+
+BENCH_SCENARIO("logging.disabled_debug", BenchDisabledDebugLog);
+
+// Request id generation and audit records per second through DB::AuditSink under each sync policy.
+static void BenchAuditSink(Bench::State &state) {
+    const int64_t n = Bench::Param("AUDITS", 200000);
+    state.Measure("request_id", n, [](int64_t) {
+        DB::Logger::setRequestId("");
+        Bench::DoNotOptimize(DB::Logger::getRequestId());
+    });
+
+    for (auto [label, policy] : {std::pair {"sync_none", DB::AuditSink::SyncPolicy::None}, std::pair {"sync_interval", DB::AuditSink::SyncPolicy::Interval}, std::pair {"sync_every_batch", DB::AuditSink::SyncPolicy::EveryBatch}}) {
+        DB::AuditSink::Options options;
+        options.fileName = Bench::WorkPath(fmt::format("audit_{}.jsonl", label));
+        options.sync = policy;
+        auto sink = std::make_shared<DB::AuditSink>(options);
+        DB::Logger::setAuditSink(sink);
+        std::string details = "sale committed, 3 items, total 125.40";
+        auto sec = state.Measure(fmt::format("{}.log_audit", label), n, [&](int64_t i) { LOG_AUDIT("commit", "sale", static_cast<int>(i), 7, details); });
+        auto start = std::chrono::steady_clock::now();
+        sink->Flush();
+        sec += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        state.Report(fmt::format("{}.durable_records_per_sec", label), n / sec, "rec/s");
+        state.Report(fmt::format("{}.batches", label), double(sink->GetStats().batches), "batches");
+        state.Report(fmt::format("{}.fsyncs", label), double(sink->GetStats().syncs), "fsyncs");
+        DB::Logger::setAuditSink(nullptr);
+    }
+}
+
+BENCH_SCENARIO("logging.audit", BenchAuditSink);
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <thread>
+#include "bench.h"
+#include "metrics.h"
+#include "wpSQLDatabase.h"
+
+// Prepared insert + point select on an in-memory database with the metrics registry enabled and disabled.
+static void BenchStatementMetrics(Bench::State &state) {
+    const int64_t n = Bench::Param("STATEMENTS", 300000);
+    wpSQLDatabase db;
+    db.Open(":memory:");
+    db.ExecuteUpdate("create table t(id integer primary key, name text, amount real)");
+    auto insert = db.PrepareStatement("insert into t(id, name, amount) values(?, ?, ?)");
+    auto select = db.PrepareStatement("select name, amount from t where id = ?");
+    std::string name = "member-name-0000";
+
+    auto timed = [](int64_t iterations, auto &&fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < iterations; i++) fn(i);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+    // best of several alternating rounds: run-to-run noise is larger than the overhead being measured
+    double best[2][2] = {{1e18, 1e18}, {1e18, 1e18}};  // [enabled][insert, select]
+    const int rounds = static_cast<int>(Bench::Param("ROUNDS", 5));
+    for (int round = 0; round < rounds; round++) {
+        for (int side = 0; side < 2; side++) {
+            int enabled = (round + side) % 2;
+            DB::MetricsRegistry::SetEnabled(enabled);
+            db.ExecuteUpdate("delete from t");  // same table size for every run
+            db.Begin();
+            best[enabled][0] = std::min(best[enabled][0], timed(n, [&](int64_t i) {
+                insert->Bind(1, i);
+                insert->Bind(2, name);
+                insert->Bind(3, i * 0.5);
+                insert->ExecuteUpdate();
+            }));
+            db.Commit();
+            best[enabled][1] = std::min(best[enabled][1], timed(n, [&](int64_t i) {
+                select->Bind(1, i);
+                auto rs = select->ExecuteQuery();
+                while (rs->NextRow()) Bench::DoNotOptimize(rs->Get<double>(1));
+            }));
+        }
+    }
+    DB::MetricsRegistry::SetEnabled(true);
+    for (int op = 0; op < 2; op++) {
+        std::string label = op == 0 ? "insert" : "select";
+        state.Report(label + ".disabled", best[0][op], "ns/op");
+        state.Report(label + ".enabled", best[1][op], "ns/op");
+        state.Report(label + ".overhead", (best[1][op] / best[0][op] - 1) * 100, "%");
+    }
+
+    // what the instrumentation adds to one insert, measured without the statement around it
+    double perInsert = timed(n * 10, [](int64_t) {
+        DB::MetricsRegistry::ScopedTimer timer(DB::MetricsRegistry::QueryLatency(), DB::MetricsRegistry::QueryLatencySampling());
+        for (int p = 0; p < 3; p++) DB::MetricsRegistry::BytesBound().Add(8);
+    });
+    perInsert -= timed(n * 10, [](int64_t i) { Bench::DoNotOptimize(i); });
+    state.Report("insert.instrumentation", perInsert, "ns/op");
+    state.Report("insert.instrumentation_share", perInsert / best[0][0] * 100, "%");
+
+    state.Measure("counter.add", n * 10, [](int64_t) { DB::MetricsRegistry::RowsStepped().Add(); });
+    state.Measure("histogram.observe", n * 10, [](int64_t i) { DB::MetricsRegistry::QueryLatency().Observe(i); });
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([n] {
+            for (int64_t i = 0; i < n * 10; i++) DB::MetricsRegistry::RowsStepped().Add();
+        });
+    for (auto &t : threads) t.join();
+    state.Report("counter.add_4_threads", std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (n * 40), "ns/op");
+    state.Report("prometheus_bytes", double(DB::MetricsRegistry::ToPrometheus().size()), "bytes");
+}
+
+BENCH_SCENARIO("metrics.statement", BenchStatementMetrics);
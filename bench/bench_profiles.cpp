@@ -0,0 +1,80 @@
+#include <filesystem>
+#include <random>
+#include "bench.h"
+#include "member_db.h"
+#include "ulid.hpp"
+
+namespace {
+    class ProfileDb : public MemberDb {
+    public:
+        ProfileDb(const std::string &fileName, DB::TuningProfile profile) {
+            SetDBName(fileName);
+            SetTuningProfile(profile);
+        }
+    };
+}  // namespace
+
+// Effect of each DB::TuningProfile on the sample member schema: bulk insert, point lookups by ulid and an aggregate scan.
+static void BenchTuningProfiles(Bench::State &state) {
+    const int64_t nMembers = Bench::Param("MEMBERS", 50000);
+    const int64_t nTrans = Bench::Param("TRANSACTIONS", 200000);
+    const int64_t nReads = Bench::Param("READS", 100000);
+
+    for (auto profile : {DB::TuningProfile::Default, DB::TuningProfile::OLTP, DB::TuningProfile::BulkLoad, DB::TuningProfile::ReadOnlyAnalytics, DB::TuningProfile::LowMemory}) {
+        auto label = DB::TuningSettings::Name(profile);
+        auto fileName = Bench::WorkPath(fmt::format("profile_{}.db", label));
+        std::mt19937_64 rng(42);
+        std::vector<ULID> memberIds;
+        memberIds.reserve(nMembers);
+        sqlite3_int64 current, highWater;
+        sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &current, &highWater, 1);  // reset high water mark
+
+        ProfileDb db(fileName, profile);
+        db.Open(true);
+        auto &session = db.GetSession();
+        auto insertMember = session.PrepareStatement("insert into members(id, dob, noOfTrans, timeCreated) values(?,?,?,?)");
+        auto insertTrans = session.PrepareStatement("insert into memberTransactions(id, amount, timeCreated) values(?,?,?)");
+        session.Begin();
+        state.Measure(label + ".insert_members", nMembers, [&](int64_t i) {
+            memberIds.emplace_back();
+            insertMember->Bind(1, memberIds.back());
+            insertMember->Bind(2, static_cast<int64_t>(rng() % 30000));
+            insertMember->Bind(3, 0);
+            insertMember->Bind(4, static_cast<int64_t>(memberIds.back().timestamp()));
+            insertMember->ExecuteUpdate();
+        });
+        state.Measure(label + ".insert_transactions", nTrans, [&](int64_t i) {
+            if (i % 50000 == 0) {
+                session.Commit();
+                session.Begin();
+            }
+            ULID id;
+            insertTrans->Bind(1, id);
+            insertTrans->Bind(2, static_cast<int64_t>(rng() % 100000));
+            insertTrans->Bind(3, static_cast<int64_t>(id.timestamp()));
+            insertTrans->ExecuteUpdate();
+        });
+        session.Commit();
+        insertMember.reset();
+        insertTrans.reset();
+
+        auto select = session.PrepareStatement("select dob, timeCreated from members where id=?");
+        state.Measure(label + ".point_read", nReads, [&](int64_t) {
+            select->Bind(1, memberIds[rng() % memberIds.size()]);
+            auto rs = select->ExecuteQuery();
+            if (rs->NextRow()) Bench::DoNotOptimize(rs->Get<int64_t>(0));
+        });
+        select.reset();
+        state.Measure(label + ".aggregate_scan", 3, [&](int64_t) {
+            Bench::DoNotOptimize(session.ExecuteScalar("select sum(amount) from memberTransactions where amount > 5000"));
+        });
+
+        sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &current, &highWater, 0);
+        state.Report(label + ".sqlite_memory_highwater", highWater / 1048576.0, "MB");
+        state.Report(label + ".page_size", double(session.ExecuteScalar("pragma page_size")), "bytes");
+        db.Close();
+        state.Report(label + ".file_size", std::filesystem::file_size(fileName) / 1048576.0, "MB");
+    }
+}
+
+BENCH_SCENARIO("profiles.member_schema", BenchTuningProfiles);
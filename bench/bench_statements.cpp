@@ -0,0 +1,171 @@
+#include "bench.h"
+#include "wpSQLDatabase.h"
+
+// Point query by primary key through each statement path, with heap allocations per query.
+static void BenchStatementPaths(Bench::State &state) {
+    const int64_t n = Bench::Param("STATEMENTS", 300000);
+    const int64_t nRows = 10000;
+    wpSQLDatabase db;
+    db.Open(":memory:");
+    db.ExecuteUpdate("create table t(id integer primary key, name text, amount real)");
+    db.Begin();
+    auto insert = db.PrepareStatement("insert into t(id, name, amount) values(?, ?, ?)");
+    for (int64_t i = 0; i < nRows; i++) {
+        insert->Bind(1, i);
+        insert->Bind(2, fmt::format("member-{}", i));
+        insert->Bind(3, i * 0.5);
+        insert->ExecuteUpdate();
+    }
+    db.Commit();
+    const std::string sql = "select amount from t where id = ?";
+
+    auto run = [&](const std::string &name, auto &&fn) {
+        fn(0);  // first call prepares, fills the cache and attaches the metrics block
+        int64_t before = Bench::Allocations();
+        state.Measure(name, n, fn);
+        state.Report(name + ".allocs_per_op", double(Bench::Allocations() - before) / n, "allocs");
+    };
+    double sum = 0;
+    run("prepare_per_call", [&](int64_t i) {
+        auto stmt = db.PrepareStatement(sql);
+        stmt->Bind(1, i % nRows);
+        auto rs = stmt->ExecuteQuery();
+        while (rs->NextRow()) sum += rs->Get<double>(0);
+    });
+    db.EnableStatementCache();
+    uint64_t hitsBefore = DB::MetricsRegistry::StatementCacheHits().Value();
+    run("prepare_per_call_cached", [&](int64_t i) {
+        auto stmt = db.PrepareStatement(sql);
+        stmt->Bind(1, i % nRows);
+        auto rs = stmt->ExecuteQuery();
+        while (rs->NextRow()) sum += rs->Get<double>(0);
+    });
+    state.Report("prepare_per_call_cached.hit_ratio", double(DB::MetricsRegistry::StatementCacheHits().Value() - hitsBefore) / (n + 1) * 100, "%");
+    db.DisableStatementCache();
+
+    auto select = db.PrepareStatement(sql);
+    run("prepared.execute_query", [&](int64_t i) {
+        select->Bind(1, i % nRows);
+        auto rs = select->ExecuteQuery();
+        while (rs->NextRow()) sum += rs->Get<double>(0);
+    });
+    run("prepared.query", [&](int64_t i) {
+        select->Bind(1, i % nRows);
+        auto rs = select->Query();
+        while (rs.NextRow()) sum += rs.Get<double>(0);
+    });
+    run("prepared.execute_scalar", [&](int64_t i) {
+        select->Bind(1, i % nRows);
+        sum += select->ExecuteScalar<double>();
+    });
+    Bench::DoNotOptimize(sum);
+}
+
+BENCH_SCENARIO("statement.point_query", BenchStatementPaths);
+
+// Parameters bound with a copy (Bind) against without (BindView), on a statement that only evaluates them.
+// wpSQLDatabase::Open creates UTF-16 databases, where sqlite converts bound UTF-8 text anyway; blobs show the copy alone.
+static void BenchBindText(Bench::State &state) {
+    const int64_t n = Bench::Param("STATEMENTS", 300000);
+    wpSQLDatabase db;
+    db.Open(":memory:");
+    auto select = db.PrepareStatement("select ? is null");  // reads nothing of the value, so the bind itself is measured
+    int64_t total = 0;
+    for (size_t size : {size_t(64), size_t(4096)}) {
+        std::string text(size, 'x');
+        std::wstring wide(size, L'x');
+        std::vector<uint8_t> bytes(size, 0x5a);
+        auto run = [&](const std::string &name, auto &&bind) {
+            int64_t before = Bench::Allocations();
+            state.Measure(fmt::format("{}_{}", name, size), n, [&](int64_t) {
+                bind();
+                total += select->ExecuteScalar();
+            });
+            state.Report(fmt::format("{}_{}.allocs_per_op", name, size), double(Bench::Allocations() - before) / n, "allocs");
+        };
+        run("bind_string", [&] { select->Bind(1, text); });
+        run("bind_view", [&] { select->BindView(1, text); });
+        run("bind_wstring", [&] { select->Bind(1, wide); });
+        run("bind_blob", [&] { select->Bind(1, std::pair<const uint8_t *, size_t>(bytes.data(), bytes.size())); });
+        run("bind_blob_view", [&] { select->BindView(1, std::span<const uint8_t>(bytes)); });
+    }
+    Bench::DoNotOptimize(total);
+}
+
+BENCH_SCENARIO("statement.bind_text", BenchBindText);
+
+namespace {
+    struct Line {
+        int64_t id;
+        std::string code;
+        double amount;
+        int64_t qty;
+        static constexpr auto wpSQLParams = std::make_tuple(std::pair {"@id", &Line::id}, std::pair {"@code", &Line::code}, std::pair {"@amount", &Line::amount}, std::pair {"@qty", &Line::qty});
+    };
+}
+
+// An 8-parameter insert bound by position, by runtime name, by compile-time name and as a struct, then
+// prepared and bound by name on every call through the statement cache.
+static void BenchNamedBind(Bench::State &state) {
+    const int64_t n = Bench::Param("STATEMENTS", 300000);
+    wpSQLDatabase db;
+    db.Open(":memory:");
+    auto select = db.PrepareStatement("select @id, @code, @amount, @qty, @branch, @terminal, @cashier, @shift");
+    std::string code = "SKU-000123";
+    auto run = [&](const std::string &name, auto &&bind) {
+        state.Measure(name, n, [&](int64_t i) {
+            bind(i);
+            Bench::DoNotOptimize(select->ExecuteScalar());
+        });
+    };
+    run("positional", [&](int64_t i) {
+        select->Bind(1, i), select->Bind(2, code), select->Bind(3, i * 0.5), select->Bind(4, i);
+        select->Bind(5, i), select->Bind(6, i), select->Bind(7, i), select->Bind(8, i);
+    });
+    run("by_name", [&](int64_t i) {
+        select->Bind("@id", i), select->Bind("@code", code), select->Bind("@amount", i * 0.5), select->Bind("@qty", i);
+        select->Bind("@branch", i), select->Bind("@terminal", i), select->Bind("@cashier", i), select->Bind("@shift", i);
+    });
+    run("by_fixed_name", [&](int64_t i) {
+        select->Bind<"@id">(i), select->Bind<"@code">(code), select->Bind<"@amount">(i * 0.5), select->Bind<"@qty">(i);
+        select->Bind<"@branch">(i), select->Bind<"@terminal">(i), select->Bind<"@cashier">(i), select->Bind<"@shift">(i);
+    });
+    run("tuple_and_struct", [&](int64_t i) {
+        select->BindStruct(Line {i, code, i * 0.5, i});
+        select->BindTuple({"@branch", "@terminal", "@cashier", "@shift"}, std::tuple(i, i, i, i));
+    });
+    // prepared per call through the statement cache: the name lookups come back with the cached statement
+    db.EnableStatementCache();
+    state.Measure("cached_prepare_by_name", n, [&](int64_t i) {
+        auto stmt = db.PrepareStatement("select @id, @code, @amount, @qty, @branch, @terminal, @cashier, @shift");
+        stmt->Bind("@id", i), stmt->Bind("@code", code), stmt->Bind("@amount", i * 0.5), stmt->Bind("@qty", i);
+        stmt->Bind("@branch", i), stmt->Bind("@terminal", i), stmt->Bind("@cashier", i), stmt->Bind("@shift", i);
+        Bench::DoNotOptimize(stmt->ExecuteScalar());
+    });
+}
+
+BENCH_SCENARIO("statement.named_bind", BenchNamedBind);
+
+// A 6-column row read by position, by name through Get<T>("col") and by name through the old pattern of looking the index up first.
+static void BenchColumnByName(Bench::State &state) {
+    const int64_t n = Bench::Param("STATEMENTS", 300000);
+    wpSQLDatabase db;
+    db.Open(":memory:");
+    auto select = db.PrepareStatement("select 1 as Id, 'SKU-000123' as Code, 2.5 as Amount, 3 as Qty, 4 as Branch, 5 as Terminal");
+    double sum = 0;
+    auto run = [&](const std::string &name, auto &&read) {
+        state.Measure(name, n, [&](int64_t) {
+            auto rs = select->Query();
+            if (rs.NextRow()) sum += read(rs);
+        });
+    };
+    run("positional", [](wpSQLResultSet &rs) { return rs.Get<int64_t>(0) + rs.Get<double>(2) + rs.Get<int64_t>(3) + rs.Get<int64_t>(4) + rs.Get<int64_t>(5); });
+    run("by_name", [](wpSQLResultSet &rs) { return rs.Get<int64_t>("id") + rs.Get<double>("amount") + rs.Get<int64_t>("qty") + rs.Get<int64_t>("branch") + rs.Get<int64_t>("terminal"); });
+    run("index_then_position", [](wpSQLResultSet &rs) {
+        return rs.Get<int64_t>(rs.GetColumnIndex("id")) + rs.Get<double>(rs.GetColumnIndex("amount")) + rs.Get<int64_t>(rs.GetColumnIndex("qty")) +
+            rs.Get<int64_t>(rs.GetColumnIndex("branch")) + rs.Get<int64_t>(rs.GetColumnIndex("terminal"));
+    });
+    Bench::DoNotOptimize(sum);
+}
+
+BENCH_SCENARIO("resultset.column_by_name", BenchColumnByName);
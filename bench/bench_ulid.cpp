@@ -0,0 +1,133 @@
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <fmt/format.h>
+#include "bench.h"
+#include "ulid.hpp"
+
+namespace {
+    // the hash std::hash<ULID> used before: first 8 bytes only
+    struct LegacyULIDHash {
+        size_t operator()(const ULID &ulid) const {
+            const uint8_t *data = ulid.data();
+            size_t result = 0;
+            for (int i = 0; i < 8; ++i) { result = (result << 8) | data[i]; }
+            return result;
+        }
+    };
+
+    template<typename Hash> void MapInsertLookup(Bench::State &state, const std::string &label, const std::vector<ULID> &ids) {
+        std::unordered_map<ULID, int64_t, Hash> map;
+        map.reserve(ids.size());
+        state.Measure(label + ".insert", ids.size(), [&](int64_t i) { map.emplace(ids[i], i); });
+        int64_t found = 0;
+        state.Measure(label + ".lookup", ids.size(), [&](int64_t i) { found += map.count(ids[(i * 7919) % ids.size()]); });
+        Bench::DoNotOptimize(found);
+        size_t longest = 0;
+        for (size_t b = 0; b < map.bucket_count(); b++) longest = std::max(longest, map.bucket_size(b));
+        state.Report(label + ".longest_bucket", double(longest), "entries");
+    }
+}  // namespace
+
+// unordered_map<ULID> insert and lookup for ids generated in bursts (thousands per millisecond).
+static void BenchULIDHash(Bench::State &state) {
+    const int64_t n = Bench::Param("ULIDS", 10000000);
+    std::vector<ULID> ids;
+    ids.reserve(n);
+    for (int64_t i = 0; i < n; i++) ids.emplace_back();
+    state.Report("ids_per_ms", double(n) / std::max<uint64_t>(1, ids.back().timestamp() - ids.front().timestamp() + 1), "ids");
+
+    MapInsertLookup<std::hash<ULID>>(state, "hash128", ids);
+    // the old hash degrades quadratically within a burst, so it only gets a prefix of the ids
+    const int64_t nLegacy = std::min(n, Bench::Param("LEGACY_ULIDS", 200000));
+    state.Report("legacy_ids", double(nLegacy), "ids");
+    MapInsertLookup<LegacyULIDHash>(state, "legacy", std::vector<ULID>(ids.begin(), ids.begin() + nLegacy));
+}
+
+BENCH_SCENARIO("ulid.hash", BenchULIDHash);
+
+// ids/sec for one-at-a-time generation, generateBatch and the process-wide monotonic mode, single and multi threaded.
+static void BenchULIDGenerate(Bench::State &state) {
+    const int64_t n = Bench::Param("ULIDS", 10000000);
+    const int64_t batch = Bench::Param("BATCH", 1024);
+    const int nThreads = static_cast<int>(Bench::Param("THREADS", std::max(2u, std::thread::hardware_concurrency())));
+    std::vector<ULID> buffer(batch, ULID::empty);
+
+    auto runThreads = [&](const std::string &label, std::function<void(int64_t)> fn) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nThreads; t++) threads.emplace_back([&] { fn(n / nThreads); });
+        for (auto &t : threads) t.join();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        state.Report(label, n / sec, "ids/s");
+    };
+    auto single = [](int64_t count) {
+        for (int64_t i = 0; i < count; i++) Bench::DoNotOptimize(ULID());
+    };
+    auto batched = [batch](int64_t count) {
+        std::vector<ULID> ids(batch, ULID::empty);
+        for (int64_t i = 0; i < count; i += batch) ULID::generateBatch(ids);
+        Bench::DoNotOptimize(ids);
+    };
+
+    for (bool monotonic : {false, true}) {
+        ULID::setProcessMonotonic(monotonic);
+        std::string mode = monotonic ? "process_monotonic" : "thread_local";
+        state.Measure(mode + ".single", n, [&](int64_t) { Bench::DoNotOptimize(ULID()); });
+        auto sec = state.Measure(mode + ".batch", n / batch, [&](int64_t) { ULID::generateBatch(buffer); });
+        state.Report(mode + ".batch.ids_per_sec", sec > 0 ? (n / batch) * batch / sec : 0, "ids/s");
+        runThreads(fmt::format("{}.single.{}_threads", mode, nThreads), single);
+        runThreads(fmt::format("{}.batch.{}_threads", mode, nThreads), batched);
+    }
+    ULID::setProcessMonotonic(false);
+}
+
+BENCH_SCENARIO("ulid.generate", BenchULIDGenerate);
+
+namespace {
+    // the bit-accumulator encoder ULID::toString used before
+    std::string LegacyToString(const ULID &id) {
+        static const char encoding[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+        std::string result;
+        result.reserve(26);
+        uint64_t accumulator = 0;
+        int bits = 0;
+        for (uint8_t byte : id.binary()) {
+            accumulator = (accumulator << 8) | byte;
+            bits += 8;
+            while (bits >= 5) {
+                bits -= 5;
+                result.push_back(encoding[(accumulator >> bits) & 0x1F]);
+            }
+        }
+        if (bits > 0) result.push_back(encoding[(accumulator << (5 - bits)) & 0x1F]);
+        return result;
+    }
+}  // namespace
+
+// Base32/hex encode and decode, per id into std::string and in bulk into one buffer.
+static void BenchULIDCodec(Bench::State &state) {
+    const int64_t n = Bench::Param("ULIDS", 1000000);
+    auto ids = ULID::generateBatch(n);
+    std::vector<std::string> text(n), hex(n);
+    for (int64_t i = 0; i < n; i++) {
+        text[i] = ids[i].toString();
+        hex[i] = ids[i].toHex();
+    }
+
+    state.Measure("base32.legacy_to_string", n, [&](int64_t i) { Bench::DoNotOptimize(LegacyToString(ids[i])); });
+    state.Measure("base32.to_string", n, [&](int64_t i) { Bench::DoNotOptimize(ids[i].toString()); });
+    std::string buffer(n * (ULID::STRING_LENGTH + 1), '\0');
+    auto sec = state.Measure("base32.encode_batch", 1, [&](int64_t) { Bench::DoNotOptimize(ULID::encodeBatch(ids, buffer.data(), ',')); });
+    state.Report("base32.encode_batch.ns_per_id", sec * 1e9 / n, "ns");
+    ULID out(ULID::empty);
+    state.Measure("base32.decode", n, [&](int64_t i) { Bench::DoNotOptimize(ULID::decode(text[i], out)); });
+
+    state.Measure("hex.to_hex", n, [&](int64_t i) { Bench::DoNotOptimize(ids[i].toHex()); });
+    buffer.resize(n * ULID::HEX_LENGTH);
+    sec = state.Measure("hex.encode_batch", 1, [&](int64_t) { Bench::DoNotOptimize(ULID::encodeHexBatch(ids, buffer.data())); });
+    state.Report("hex.encode_batch.ns_per_id", sec * 1e9 / n, "ns");
+    state.Measure("hex.from_hex", n, [&](int64_t i) { Bench::DoNotOptimize(ULID::fromHex(hex[i])); });
+}
+
+BENCH_SCENARIO("ulid.codec", BenchULIDCodec);
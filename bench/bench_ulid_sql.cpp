@@ -0,0 +1,50 @@
+#include <random>
+#include "bench.h"
+#include "member_db.h"
+
+// Time-range query on MemberTransactions: scanning timeCreated against a primary key range built with ulid_min_for_time/ulid_max_for_time.
+static void BenchULIDTimeRange(Bench::State &state) {
+    const int64_t nTrans = Bench::Param("TRANSACTIONS", 1000000);
+    const int64_t nQueries = Bench::Param("QUERIES", 200);
+    const int64_t spanMs = 365LL * 24 * 3600 * 1000;  // a year of history
+    const int64_t windowMs = 24LL * 3600 * 1000;      // one day per query
+    const int64_t start = 1700000000000LL;
+
+    MemberDb db;
+    db.SetDBName(Bench::WorkPath("ulid_time_range.db"));
+    db.Open(true);
+    auto &session = db.GetSession();
+    std::mt19937_64 rng(42);
+    auto insert = session.PrepareStatement("insert into memberTransactions(id, amount, timeCreated) values(?,?,?)");
+    session.Begin();
+    for (int64_t i = 0; i < nTrans; i++) {
+        int64_t ms = start + static_cast<int64_t>(rng() % spanMs);
+        insert->Bind(1, ULID::generate(ms));
+        insert->Bind(2, static_cast<int64_t>(rng() % 100000));
+        insert->Bind(3, ms);
+        insert->ExecuteUpdate();
+    }
+    session.Commit();
+    insert.reset();
+
+    auto byTime = session.PrepareStatement("select count(*), sum(amount) from memberTransactions where timeCreated between ? and ?");
+    auto byKey = session.PrepareStatement("select count(*), sum(amount) from memberTransactions where id between ulid_min_for_time(?) and ulid_max_for_time(?)");
+    int64_t rowsByTime = 0, rowsByKey = 0;
+    auto run = [&](std::shared_ptr<wpSQLStatement> &stt, int64_t &rows, int64_t i) {
+        int64_t from = start + (i * 7919 * 3600000LL) % (spanMs - windowMs);
+        stt->Bind(1, from);
+        stt->Bind(2, from + windowMs - 1);
+        auto rs = stt->ExecuteQuery();
+        if (rs->NextRow()) rows += rs->Get<int64_t>(0);
+    };
+    state.Measure("scan_timeCreated", nQueries, [&](int64_t i) { run(byTime, rowsByTime, i); });
+    state.Measure("pk_range", nQueries, [&](int64_t i) { run(byKey, rowsByKey, i); });
+    if (rowsByTime != rowsByKey) LOG_ERROR("ulid.time_range: row counts differ {} vs {}", rowsByTime, rowsByKey);
+    state.Report("rows_per_query", double(rowsByKey) / nQueries, "rows");
+    byTime.reset();
+    byKey.reset();
+
+    state.Measure("ulid_time_udf", 1, [&](int64_t) { Bench::DoNotOptimize(session.ExecuteScalar("select max(ulid_time(id)) from memberTransactions")); });
+}
+
+BENCH_SCENARIO("ulid.time_range", BenchULIDTimeRange);
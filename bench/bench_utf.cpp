@@ -0,0 +1,39 @@
+#include "bench.h"
+#include "wpSQLDatabase.h"
+
+// UTF-8 <-> wchar_t: boost::locale::conv::utf_to_utf against wpUTF, on ascii and on mixed Malay/Chinese text,
+// then std::wstring bind and read through a statement.
+static void BenchUtf(Bench::State &state) {
+    const int64_t n = Bench::Param("UTF_ITERATIONS", 20000);
+    std::string ascii, mixed;
+    while (ascii.size() < 4096) ascii += "Invoice 2024-118 Kedai Runcit Ahmad, Jalan Ampang; ";
+    while (mixed.size() < 4096) mixed += "Kedai Runcit Ahmad 陈记杂货店 Jalan Ampang 吉隆坡 ";
+    for (auto &[label, text] : {std::pair<std::string, std::string &>("ascii", ascii), std::pair<std::string, std::string &>("mixed", mixed)}) {
+        std::wstring wide = wpUTF::ToWide(text);
+        const double mb = double(text.size()) * n / (1024 * 1024);
+        size_t sink = 0;
+        double sec = state.Measure(label + ".to_wide.boost", n, [&](int64_t) { sink += boost::locale::conv::utf_to_utf<wchar_t>(text).size(); });
+        state.Report(label + ".to_wide.boost.mb_per_sec", mb / sec, "MB/s");
+        sec = state.Measure(label + ".to_wide.wputf", n, [&](int64_t) { sink += wpUTF::ToWide(text).size(); });
+        state.Report(label + ".to_wide.wputf.mb_per_sec", mb / sec, "MB/s");
+        sec = state.Measure(label + ".to_utf8.boost", n, [&](int64_t) { sink += boost::locale::conv::utf_to_utf<char>(wide).size(); });
+        state.Report(label + ".to_utf8.boost.mb_per_sec", mb / sec, "MB/s");
+        sec = state.Measure(label + ".to_utf8.wputf", n, [&](int64_t) { sink += wpUTF::ToUTF8(wide).size(); });
+        state.Report(label + ".to_utf8.wputf.mb_per_sec", mb / sec, "MB/s");
+        Bench::DoNotOptimize(sink);
+    }
+
+    wpSQLDatabase db;
+    db.Open(":memory:");
+    auto select = db.PrepareStatement("select ?");
+    std::wstring wide = wpUTF::ToWide(mixed.substr(0, 120));
+    size_t total = 0;
+    state.Measure("statement.bind_get_wstring", n * 10, [&](int64_t) {
+        select->Bind(1, wide);
+        auto rs = select->Query();
+        if (rs.NextRow()) total += rs.Get<std::wstring>(0).size();
+    });
+    Bench::DoNotOptimize(total);
+}
+
+BENCH_SCENARIO("utf.transcode", BenchUtf);
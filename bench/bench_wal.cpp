@@ -0,0 +1,79 @@
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include "bench.h"
+#include "rDb.h"
+
+// Sustained writes with a concurrent reader, with sqlite's commit-time autocheckpoint and with DB::WalCheckpointer.
+static void BenchWalCheckpointer(Bench::State &state) {
+    const int64_t nRows = Bench::Param("ROWS", 300000);
+    const int64_t batch = Bench::Param("BATCH", 1000);
+    const std::string payload(200, 'x');
+
+    for (bool background : {false, true}) {
+        std::string label = background ? "checkpointer" : "autocheckpoint";
+        auto fileName = Bench::WorkPath(fmt::format("wal_{}.db", label));
+        DB::SQLiteBase db(fileName);
+        db.Open();
+        db.GetSession().ExecuteUpdate("create table log(id integer primary key, payload text)");
+        if (background) {
+            DB::WalCheckpointer::Options options;
+            options.interval = std::chrono::milliseconds(Bench::Param("INTERVAL_MS", 100));
+            options.escalateBytes = 4LL << 20;
+            options.capBytes = 32LL << 20;
+            db.StartWalCheckpointer(options);
+        }
+
+        std::atomic<bool> done {false};
+        std::atomic<int64_t> reads {0}, readNanos {0}, maxReadNanos {0}, maxWal {0};
+        std::thread reader([&] {
+            DB::SQLiteBase rdb(fileName);
+            rdb.Open(false, OpenMode::ReadOnly);
+            auto stt = rdb.GetSession().PrepareStatement("select payload from log where id=?");
+            int64_t key = 1;
+            while (!done) {
+                auto start = std::chrono::steady_clock::now();
+                stt->Bind(1, key = key * 7919 % (nRows + 1) + 1);
+                auto rs = stt->ExecuteQuery();
+                if (rs->NextRow()) Bench::DoNotOptimize(rs->Get(0));
+                int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                reads++;
+                readNanos += ns;
+                if (ns > maxReadNanos) maxReadNanos = ns;
+                int64_t wal = std::filesystem::exists(fileName + "-wal") ? std::filesystem::file_size(fileName + "-wal") : 0;
+                if (wal > maxWal) maxWal = wal;
+            }
+        });
+
+        auto insert = db.GetSession().PrepareStatement("insert into log(id, payload) values(?,?)");
+        state.Measure(label + ".insert", nRows, [&](int64_t i) {
+            if (i % batch == 0) {
+                if (i > 0) db.GetSession().Commit();
+                db.GetSession().Begin();
+            }
+            insert->Bind(1, i + 1);
+            insert->Bind(2, payload);
+            insert->ExecuteUpdate();
+        });
+        db.GetSession().Commit();
+        done = true;
+        reader.join();
+        insert.reset();
+
+        state.Report(label + ".read_avg", reads ? double(readNanos) / reads / 1000.0 : 0, "us");
+        state.Report(label + ".read_max", maxReadNanos / 1000.0, "us");
+        state.Report(label + ".wal_max", maxWal / 1048576.0, "MB");
+        if (auto ckpt = db.GetWalCheckpointer()) {
+            auto &m = ckpt->GetMetrics();
+            state.Report(label + ".checkpoint_max", m.maxDurationMicros / 1000.0, "ms");
+            state.Report(label + ".checkpoint_passive", double(m.passiveCount), "runs");
+            state.Report(label + ".checkpoint_truncate", double(m.truncateCount), "runs");
+            state.Report(label + ".checkpoint_busy", double(m.busyCount), "runs");
+            state.Report(label + ".checkpoint_error", double(m.errorCount), "runs");
+            state.Report(label + ".wal_frames_last", double(m.walFrames), "frames");
+        }
+        db.Close();
+    }
+}
+
+BENCH_SCENARIO("wal.checkpointer", BenchWalCheckpointer);
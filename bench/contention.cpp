@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <fmt/format.h>
+#include "bench.h"
+#include "logging.hpp"
+#include "metrics.h"
+#include "rDb.h"
+
+/**
+ * Lock contention stress harness.
+ *
+ * Writers and readers each run on their own SQLiteBase connection against one
+ * database file for a fixed time. Writers insert txRows rows per transaction,
+ * readers run point lookups; both pause thinkUs between operations. The run
+ * reports throughput, busy waits and latency percentiles, so busy-handler,
+ * WAL and tuning changes can be compared on one machine.
+ *
+ *   wpsql_contention --writers=4 --readers=8 --seconds=10 --tx-rows=20 --think-us=500 --json=run.json
+ */
+namespace fs = std::filesystem;
+
+namespace {
+    struct Options {
+        int writers {2};
+        int readers {4};
+        int seconds {10};
+        int txRows {10};
+        int readRows {1};
+        int64_t writerThinkUs {0};
+        int64_t readerThinkUs {0};
+        bool wal {true};
+        bool checkpointer {false};
+        DB::TuningProfile profile {DB::TuningProfile::OLTP};
+        std::string file {"bench_work/contention.db"};
+        std::string jsonFile;
+        std::string label;
+    };
+
+    struct ThreadStats {
+        std::vector<int64_t> latencies;  // ns per transaction or query
+        int64_t operations {0};
+        int64_t rows {0};
+        int64_t busyErrors {0};
+        int64_t otherErrors {0};
+    };
+
+    bool ParseProfile(const std::string &name, DB::TuningProfile &profile) {
+        for (auto p : {DB::TuningProfile::Default, DB::TuningProfile::OLTP, DB::TuningProfile::BulkLoad, DB::TuningProfile::ReadOnlyAnalytics, DB::TuningProfile::LowMemory}) {
+            if (boost::iequals(DB::TuningSettings::Name(p), name)) {
+                profile = p;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Think(int64_t us) {
+        if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+
+    int64_t Elapsed(std::chrono::steady_clock::time_point start) { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(); }
+
+    void Writer(const Options &opt, int id, std::atomic<bool> &stop, ThreadStats &stats) {
+        DB::SQLiteBase db(opt.file, false, false, opt.wal);
+        db.SetTuningProfile(opt.profile);
+        db.Open();
+        auto &session = db.GetSession();
+        auto insert = session.PrepareStatement("insert into contention(writer, seq, payload) values(?, ?, ?)");
+        std::string payload(100, 'w');
+        int64_t seq = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                session.Begin();
+                for (int i = 0; i < opt.txRows; i++) {
+                    insert->Bind(1, id);
+                    insert->Bind(2, seq++);
+                    insert->Bind(3, payload);
+                    insert->ExecuteUpdate();
+                }
+                session.Commit();
+                stats.latencies.push_back(Elapsed(start));
+                stats.operations++;
+                stats.rows += opt.txRows;
+            } catch (wpSQLException &e) {
+                if (!session.IsAutoCommit()) session.Rollback();
+                (e.rc == SQLITE_BUSY || e.rc == SQLITE_LOCKED ? stats.busyErrors : stats.otherErrors)++;
+            }
+            Think(opt.writerThinkUs);
+        }
+        db.Close();
+    }
+
+    void Reader(const Options &opt, int id, std::atomic<bool> &stop, ThreadStats &stats) {
+        DB::SQLiteBase db(opt.file, false, false, opt.wal);
+        db.SetTuningProfile(opt.profile);
+        db.Open();
+        auto &session = db.GetSession();
+        auto select = session.PrepareStatement("select writer, seq, payload from contention where id between ? and ?");
+        std::mt19937_64 rng(id);
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                int64_t maxId = session.ExecuteScalar("select coalesce(max(id), 0) from contention");
+                int64_t from = maxId > 0 ? int64_t(rng() % maxId) + 1 : 0;
+                select->Bind(1, from);
+                select->Bind(2, from + opt.readRows - 1);
+                auto rs = select->ExecuteQuery();
+                while (rs->NextRow()) stats.rows++;
+                stats.latencies.push_back(Elapsed(start));
+                stats.operations++;
+            } catch (wpSQLException &e) {
+                (e.rc == SQLITE_BUSY || e.rc == SQLITE_LOCKED ? stats.busyErrors : stats.otherErrors)++;
+            }
+            Think(opt.readerThinkUs);
+        }
+        db.Close();
+    }
+
+    // merges the per-thread stats of one role into its report lines
+    void Summarize(const std::string &role, std::vector<ThreadStats> &stats, double seconds, std::vector<Bench::Result> &results) {
+        std::vector<int64_t> all;
+        ThreadStats total;
+        for (auto &s : stats) {
+            all.insert(all.end(), s.latencies.begin(), s.latencies.end());
+            total.operations += s.operations;
+            total.rows += s.rows;
+            total.busyErrors += s.busyErrors;
+            total.otherErrors += s.otherErrors;
+        }
+        std::sort(all.begin(), all.end());
+        auto percentile = [&all](double p) { return all.empty() ? 0.0 : all[std::min(all.size() - 1, size_t(p * all.size()))] / 1e3; };
+        results.push_back({"contention", role + ".ops_per_sec", total.operations / seconds, "ops/s"});
+        results.push_back({"contention", role + ".rows_per_sec", total.rows / seconds, "rows/s"});
+        results.push_back({"contention", role + ".busy_errors", double(total.busyErrors), "count"});
+        results.push_back({"contention", role + ".other_errors", double(total.otherErrors), "count"});
+        results.push_back({"contention", role + ".p50", percentile(0.50), "us"});
+        results.push_back({"contention", role + ".p99", percentile(0.99), "us"});
+        results.push_back({"contention", role + ".p999", percentile(0.999), "us"});
+        results.push_back({"contention", role + ".max", all.empty() ? 0.0 : all.back() / 1e3, "us"});
+    }
+
+    // same layout as wpsql_bench --json, with the run options alongside the results
+    void WriteJson(const Options &opt, const std::vector<Bench::Result> &results) {
+        auto options = fmt::format("\"options\": {{\"writers\": {}, \"readers\": {}, \"seconds\": {}, \"tx_rows\": {}, \"read_rows\": {}, \"writer_think_us\": {}, \"reader_think_us\": {}, \"wal\": {}, \"checkpointer\": {}, \"profile\": {}}}", opt.writers, opt.readers, opt.seconds, opt.txRows, opt.readRows, opt.writerThinkUs, opt.readerThinkUs, opt.wal, opt.checkpointer, Bench::JsonString(DB::TuningSettings::Name(opt.profile)));
+        Bench::WriteJson(opt.jsonFile, opt.label, results, options);
+    }
+
+    void Usage() {
+        std::cout << "usage: wpsql_contention [--writers=N] [--readers=N] [--seconds=N] [--tx-rows=N] [--read-rows=N]\n"
+                     "                        [--think-us=N] [--writer-think-us=N] [--reader-think-us=N] [--wal=0|1]\n"
+                     "                        [--checkpointer=0|1] [--profile=Default|OLTP|BulkLoad|ReadOnlyAnalytics|LowMemory]\n"
+                     "                        [--file=path] [--json=results.json] [--label=text]"
+                  << std::endl;
+    }
+}  // namespace
+
+int main(int argc, char **argv) {
+    DB::Logger::initialize("wpsql_contention", "warn");
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        std::string key = arg.substr(0, eq), value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--writers") opt.writers = std::atoi(value.c_str());
+        else if (key == "--readers") opt.readers = std::atoi(value.c_str());
+        else if (key == "--seconds") opt.seconds = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--tx-rows") opt.txRows = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--read-rows") opt.readRows = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--think-us") opt.writerThinkUs = opt.readerThinkUs = std::atoll(value.c_str());
+        else if (key == "--writer-think-us") opt.writerThinkUs = std::atoll(value.c_str());
+        else if (key == "--reader-think-us") opt.readerThinkUs = std::atoll(value.c_str());
+        else if (key == "--wal") opt.wal = value != "0";
+        else if (key == "--checkpointer") opt.checkpointer = value != "0";
+        else if (key == "--file") opt.file = value;
+        else if (key == "--json") opt.jsonFile = value;
+        else if (key == "--label") opt.label = value;
+        else if (key == "--profile" && ParseProfile(value, opt.profile)) continue;
+        else {
+            Usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<Bench::Result> results;
+    try {
+        if (fs::path(opt.file).has_parent_path()) fs::create_directories(fs::path(opt.file).parent_path());
+        for (auto suffix : {"", "-wal", "-shm", "-journal"}) fs::remove(opt.file + suffix);
+
+        DB::SQLiteBase owner(opt.file, false, false, opt.wal);  // holds the schema and, when asked, the checkpointer
+        owner.SetTuningProfile(opt.profile);
+        owner.Open();
+        owner.GetSession().ExecuteUpdate("create table contention(id integer primary key, writer integer, seq integer, payload text)");
+        if (opt.checkpointer) owner.StartWalCheckpointer();
+
+        std::cout << fmt::format("contention: {} writers x {} rows/tx, {} readers, {} s, {}, profile {}", opt.writers, opt.txRows, opt.readers, opt.seconds, opt.wal ? "wal" : "rollback journal", DB::TuningSettings::Name(opt.profile)) << std::endl;
+        std::vector<ThreadStats> writerStats(opt.writers), readerStats(opt.readers);
+        std::atomic<bool> stop {false};
+        uint64_t busyWaitsBefore = DB::MetricsRegistry::BusyWaits().Value();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        auto guarded = [](auto fn) {  // an exception escaping a thread would terminate the run without a report
+            return [fn] {
+                try {
+                    fn();
+                } catch (std::exception &e) {
+                    std::cerr << "contention thread: " << e.what() << std::endl;
+                }
+            };
+        };
+        for (int i = 0; i < opt.writers; i++) threads.emplace_back(guarded([&, i] { Writer(opt, i, stop, writerStats[i]); }));
+        for (int i = 0; i < opt.readers; i++) threads.emplace_back(guarded([&, i] { Reader(opt, i, stop, readerStats[i]); }));
+        std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+        stop = true;
+        for (auto &t : threads) t.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();  // includes the operations still running at stop
+
+        Summarize("write", writerStats, seconds, results);
+        Summarize("read", readerStats, seconds, results);
+        results.push_back({"contention", "busy_waits", double(DB::MetricsRegistry::BusyWaits().Value() - busyWaitsBefore), "count"});
+        results.push_back({"contention", "commit_latency_avg", DB::MetricsRegistry::CommitLatency().Count() ? DB::MetricsRegistry::CommitLatency().SumSeconds() * 1e6 / DB::MetricsRegistry::CommitLatency().Count() : 0.0, "us"});
+        results.push_back({"contention", "rows_in_table", double(owner.GetSession().ExecuteScalar("select count(*) from contention")), "rows"});
+        owner.Close();
+    } catch (wpSQLException &e) {
+        std::cerr << fmt::format("contention: sql exception: {}", e.message) << std::endl;
+        return 1;
+    } catch (std::exception &e) {
+        std::cerr << fmt::format("contention: std exception: {}", e.what()) << std::endl;
+        return 1;
+    }
+
+    for (auto &r : results) std::cout << fmt::format("  {:<48} {:>16.2f} {}", r.name, r.value, r.unit) << std::endl;
+    if (!opt.jsonFile.empty()) WriteJson(opt, results);
+    return 0;
+}
@@ -34,9 +34,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 */
 
 #pragma once
+#include <cstddef>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <span>
 #include <string>
 #include <stdexcept>
 #include <vector>
@@ -82,4 +85,58 @@ private:
     bool Find_And_Read_Central_Header();
 //#####################################################################
 };
+
+//#####################################################################
+// Class ZipFileMappedReader
+//#####################################################################
+// Read-only view of a zip archive mapped into memory. Stored entries are
+// returned as spans into the mapping without copying; deflated entries are
+// inflated straight into caller buffers in large chunks. The mapping is never
+// written so independent entries can be extracted from several threads.
+class ZipFileMappedReader
+{
+public:
+    struct Entry
+    {
+        std::string filename;
+        unsigned short compression_type;
+        unsigned int crc;
+        unsigned int compressed_size,uncompressed_size;
+        size_t data_offset; // offset of the entry data inside the mapping
+
+        bool Is_Stored() const
+        {return compression_type==0;}
+    };
+    // receives consecutive pieces of an entry; return false to stop extraction
+    typedef std::function<bool(const unsigned char* data,size_t size)> Sink;
+    static const size_t default_chunk_size=1<<20;
+
+private:
+    const unsigned char* base;
+    size_t length;
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#else
+    int fd;
+#endif
+    std::map<std::string,Entry> entries;
+public:
+
+//#####################################################################
+    ZipFileMappedReader(const std::string &filename);
+    virtual ~ZipFileMappedReader();
+    ZipFileMappedReader(const ZipFileMappedReader&)=delete;
+    ZipFileMappedReader& operator=(const ZipFileMappedReader&)=delete;
+    const Entry* Find(const std::string &filename) const;
+    void Get_File_List(std::vector<std::string>& filenames) const;
+    std::span<const unsigned char> Get_Raw(const std::string &filename) const;
+    std::span<const unsigned char> Get_Stored(const std::string &filename) const;
+    bool Extract(const std::string &filename,unsigned char* buffer,size_t buffer_size) const;
+    bool Extract(const std::string &filename,const Sink& sink,size_t chunk_size=default_chunk_size) const;
+    bool Extract_Parallel(const std::vector<std::string>& filenames,const std::function<Sink(const std::string&)>& sink_for,unsigned int n_threads=0) const;
+private:
+    bool Find_And_Read_Central_Header();
+//#####################################################################
+};
 }
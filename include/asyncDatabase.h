@@ -0,0 +1,354 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <variant>
+#include <vector>
+#include "wpSQLDatabase.h"
+
+namespace DB {
+    /**
+     * Cancels the async calls it is passed to. A call still queued fails with
+     * SQLITE_INTERRUPT without running; a running one is interrupted through
+     * wpSQLDatabase::Interrupt. Cancelling is best effort: sqlite only sees the
+     * interrupt while a statement is stepping, so a call that finishes anyway
+     * delivers its result.
+     */
+    class AsyncCancel {
+        struct State {
+            std::atomic<bool> cancelled {false};
+            std::mutex mtx;
+            std::vector<wpSQLDatabase *> running;
+        };
+        std::shared_ptr<State> state {std::make_shared<State>()};
+
+        friend class AsyncDatabase;
+        bool Enter(wpSQLDatabase *db) const;  // false when already cancelled
+        void Leave(wpSQLDatabase *db) const;
+
+    public:
+        void Cancel();
+        bool IsCancelled() const { return state->cancelled.load(std::memory_order_relaxed); }
+    };
+
+    // Rows copied out of a query on a worker connection, so they can be read on any thread.
+    class AsyncRows {
+    public:
+        using Value = std::variant<std::monostate, int64_t, double, std::string, std::vector<uint8_t>>;
+
+    private:
+        std::vector<std::string> columns;
+        std::vector<Value> values;  // row-major
+
+        friend class AsyncDatabase;
+        void Read(wpSQLResultSet &rs);
+
+    public:
+        size_t RowCount() const { return columns.empty() ? 0 : values.size() / columns.size(); }
+        int GetColumnCount() const { return static_cast<int>(columns.size()); }
+        const std::string &GetColumnName(int i) const { return columns.at(i); }
+        int GetColumnIndex(std::string_view name) const;  // -1 when there is no such column
+        const Value &At(size_t row, int col) const { return values.at(row * columns.size() + col); }
+        bool IsNull(size_t row, int col) const { return std::holds_alternative<std::monostate>(At(row, col)); }
+
+        template<typename T = std::string> T Get(size_t row, int col, const T &defaultValue = T {}) const {
+            const Value &v = At(row, col);
+            if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
+                if (auto blob = std::get_if<std::vector<uint8_t>>(&v)) return *blob;
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                if (auto text = std::get_if<std::string>(&v)) return *text;
+                if (auto i = std::get_if<int64_t>(&v)) return std::to_string(*i);
+                if (auto d = std::get_if<double>(&v)) return fmt::format("{}", *d);
+            } else if constexpr (std::is_arithmetic_v<T>) {
+                if (auto i = std::get_if<int64_t>(&v)) return static_cast<T>(*i);
+                if (auto d = std::get_if<double>(&v)) return static_cast<T>(*d);
+            } else {
+                static_assert(sizeof(T) == 0, "AsyncRows::Get: use an arithmetic type, std::string or std::vector<uint8_t>");
+            }
+            return defaultValue;
+        }
+        template<typename T = std::string> T Get(size_t row, std::string_view name, const T &defaultValue = T {}) const {
+            int col = GetColumnIndex(name);
+            if (col < 0) throw wpSQLException(fmt::format("AsyncRows> no column {}", name), 0, NULL);
+            return Get<T>(row, col, defaultValue);
+        }
+    };
+
+    namespace detail {
+        // completion shared by the worker and the one caller that awaits or waits on it
+        template<typename T> struct AsyncState {
+            std::variant<std::monostate, std::conditional_t<std::is_void_v<T>, std::monostate, T>, std::exception_ptr> result;
+            std::atomic<void *> waiter {nullptr};  // the suspended coroutine, or Done() once the result is in
+            std::function<void(std::function<void()>)> post;
+
+            static void *Done() { return reinterpret_cast<void *>(uintptr_t(1)); }
+
+            void Complete() {
+                void *h = waiter.exchange(Done(), std::memory_order_acq_rel);
+                waiter.notify_all();
+                if (h == nullptr || h == Done()) return;
+                auto handle = std::coroutine_handle<>::from_address(h);
+                if (post)
+                    post([handle] { handle.resume(); });
+                else
+                    handle.resume();
+            }
+        };
+    }
+
+    /**
+     * What the *Async calls return: co_await it from a coroutine, or Wait() for
+     * it from plain code. Awaited, the caller resumes through
+     * AsyncDatabase::Options::post, or on the worker thread when that is empty.
+     * Errors come back as the exception the call threw, usually wpSQLException.
+     */
+    template<typename T> class AsyncResult {
+        std::shared_ptr<detail::AsyncState<T>> state;
+
+    public:
+        explicit AsyncResult(std::shared_ptr<detail::AsyncState<T>> s) : state(std::move(s)) {}
+
+        bool await_ready() const noexcept { return state->waiter.load(std::memory_order_acquire) == state->Done(); }
+        bool await_suspend(std::coroutine_handle<> h) noexcept {
+            void *expected = nullptr;
+            return state->waiter.compare_exchange_strong(expected, h.address(), std::memory_order_acq_rel);  // false: finished meanwhile, carry on
+        }
+        T await_resume() {
+            if (auto e = std::get_if<std::exception_ptr>(&state->result)) std::rethrow_exception(*e);
+            if constexpr (!std::is_void_v<T>) return std::move(std::get<1>(state->result));
+        }
+
+        bool IsReady() const { return await_ready(); }
+        T Wait() {
+            for (void *h = state->waiter.load(); h != state->Done(); h = state->waiter.load()) state->waiter.wait(h);
+            return await_resume();
+        }
+    };
+
+    /**
+     * Runs wpSQLDatabase work on a pool of worker threads, each with its own
+     * connection to the same file, so an I/O thread can co_await queries
+     * instead of blocking on them:
+     *
+     *     DB::AsyncDatabase db("pos.db", {.connections = 4, .post = [&io](auto fn) { asio::post(io, std::move(fn)); }});
+     *     auto rows = co_await db.QueryAsync("select name from member where id = ?", id);
+     *     co_await db.RunAsync([&](wpSQLDatabase &conn) { conn.Begin(); ...; conn.Commit(); });
+     *
+     * Calls are taken in order by whichever worker is free, so two calls may
+     * run concurrently on different connections; give writers their own
+     * one-connection AsyncDatabase, or use WAL, as with any set of
+     * connections. Each worker keeps a statement cache, so repeated sql is
+     * prepared once per connection. ":memory:" gives every connection its own
+     * database; use one connection for it.
+     */
+    class AsyncDatabase {
+    public:
+        struct Options {
+            int connections {1};
+            OpenMode mode {OpenMode::ReadWrite};
+            std::string vfsName;
+            std::function<void(std::function<void()>)> post;  // where awaiting coroutines resume; empty = on the worker thread
+        };
+
+    private:
+        struct Job {
+            std::move_only_function<void(wpSQLDatabase &)> run;  // stores the result or the error, never throws
+            std::function<void()> complete;                      // hands the result over, once the worker is done with the call
+            std::function<void(std::exception_ptr)> fail;        // for jobs dropped by Stop or cancelled before they start
+            AsyncCancel cancel;
+        };
+
+        std::string dbName;
+        Options options;
+        std::vector<std::unique_ptr<wpSQLDatabase>> connections;
+        std::vector<std::thread> workers;
+        std::deque<Job> queue;
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool stopping {false};
+
+        void Run(wpSQLDatabase &db);
+        void Post(Job job);
+
+        template<typename T, typename F> AsyncResult<T> Submit(F fn, const AsyncCancel &cancel) {
+            auto state = std::make_shared<detail::AsyncState<T>>();
+            state->post = options.post;
+            auto fail = [state](std::exception_ptr e) {
+                state->result.template emplace<2>(e);
+                state->Complete();
+            };
+            Post({[state, fn = std::move(fn)](wpSQLDatabase &db) mutable {
+                      try {
+                          if constexpr (std::is_void_v<T>)
+                              fn(db);
+                          else
+                              state->result.template emplace<1>(fn(db));
+                      } catch (...) {
+                          state->result.template emplace<2>(std::current_exception());
+                      }
+                  },
+                [state] { state->Complete(); }, fail, cancel});
+            return AsyncResult<T>(state);
+        }
+
+        // string literals and char buffers are copied into a std::string, as the call may outlive them
+        template<typename A> using Stored = std::conditional_t<std::is_convertible_v<std::decay_t<A>, const char *>, std::string, std::decay_t<A>>;
+
+        template<typename Tuple> static void BindAll(wpSQLStatement &stmt, const Tuple &binds) {
+            std::apply([&stmt](const auto &...values) {
+                int i = 0;
+                (stmt.Bind(++i, values), ...);
+            }, binds);
+        }
+
+    public:
+        AsyncDatabase(const std::string &fileName, const Options &options);  // opens every connection; throws wpSQLException as Open does
+        explicit AsyncDatabase(const std::string &fileName) : AsyncDatabase(fileName, Options()) {}
+        ~AsyncDatabase() { Stop(); }  // so it must not be destroyed on one of its workers either
+        AsyncDatabase(const AsyncDatabase &) = delete;
+        AsyncDatabase &operator=(const AsyncDatabase &) = delete;
+
+        void Stop();  // interrupts running calls, fails queued ones with SQLITE_INTERRUPT and closes the connections;
+                      // throws SQLITE_MISUSE on a worker thread, e.g. from a coroutine resumed there without Options::post
+        void Interrupt();  // every running call, without cancelling what is queued
+        size_t GetQueueLength();
+        const std::string &GetFileName() const { return dbName; }
+
+        // fn(wpSQLDatabase &) on a worker connection; the connection must not escape fn
+        template<typename F> auto RunAsync(F fn, const AsyncCancel &cancel = {}) {
+            return Submit<std::invoke_result_t<F &, wpSQLDatabase &>>(std::move(fn), cancel);
+        }
+
+        // binds are copied and bound by position, 1..n
+        template<typename... Args> AsyncResult<AsyncRows> QueryAsync(const AsyncCancel &cancel, std::string sql, Args &&...binds) {
+            return Submit<AsyncRows>([sql = std::move(sql), binds = std::tuple<Stored<Args>...>(std::forward<Args>(binds)...)](wpSQLDatabase &db) {
+                auto stmt = db.PrepareStatement(sql);
+                BindAll(*stmt, binds);
+                auto rs = stmt->Query();
+                AsyncRows rows;
+                rows.Read(rs);
+                return rows;
+            }, cancel);
+        }
+        template<typename... Args> AsyncResult<AsyncRows> QueryAsync(std::string sql, Args &&...binds) {
+            return QueryAsync(AsyncCancel(), std::move(sql), std::forward<Args>(binds)...);
+        }
+
+        template<typename... Args> AsyncResult<int> ExecuteUpdateAsync(const AsyncCancel &cancel, std::string sql, Args &&...binds) {
+            return Submit<int>([sql = std::move(sql), binds = std::tuple<Stored<Args>...>(std::forward<Args>(binds)...)](wpSQLDatabase &db) {
+                auto stmt = db.PrepareStatement(sql);
+                BindAll(*stmt, binds);
+                return stmt->ExecuteUpdate();
+            }, cancel);
+        }
+        template<typename... Args> AsyncResult<int> ExecuteUpdateAsync(std::string sql, Args &&...binds) {
+            return ExecuteUpdateAsync(AsyncCancel(), std::move(sql), std::forward<Args>(binds)...);
+        }
+    };
+
+    /**
+     * Minimal coroutine type for code that has no framework of its own. It
+     * starts at once and runs until its first co_await; co_await it from
+     * another AsyncTask, or Wait() for it. Keep it alive until it is done.
+     */
+    template<typename T = void> class AsyncTask {
+    public:
+        struct promise_type;
+        using Handle = std::coroutine_handle<promise_type>;
+
+    private:
+        struct PromiseBase {
+            std::variant<std::monostate, std::conditional_t<std::is_void_v<T>, std::monostate, T>, std::exception_ptr> result;
+            std::atomic<void *> waiter {nullptr};  // awaiting coroutine, or Done() once finished
+
+            static void *Done() { return reinterpret_cast<void *>(uintptr_t(1)); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept {
+                struct Final {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(Handle h) noexcept {
+                        auto &p = h.promise();
+                        void *w = p.waiter.exchange(Done(), std::memory_order_acq_rel);
+                        p.waiter.notify_all();
+                        return w ? std::coroutine_handle<>::from_address(w) : std::noop_coroutine();
+                    }
+                    void await_resume() noexcept {}
+                };
+                return Final {};
+            }
+            void unhandled_exception() { result.template emplace<2>(std::current_exception()); }
+        };
+        struct ValuePromise : PromiseBase {
+            template<typename U> void return_value(U &&value) { this->result.template emplace<1>(std::forward<U>(value)); }
+        };
+        struct VoidPromise : PromiseBase {
+            void return_void() {}
+        };
+
+        Handle handle;
+
+    public:
+        struct promise_type : std::conditional_t<std::is_void_v<T>, VoidPromise, ValuePromise> {
+            AsyncTask get_return_object() { return AsyncTask(Handle::from_promise(*this)); }
+        };
+
+        explicit AsyncTask(Handle h) : handle(h) {}
+        AsyncTask(AsyncTask &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+        AsyncTask &operator=(AsyncTask &&) = delete;
+        ~AsyncTask() {
+            if (handle) handle.destroy();
+        }
+
+        bool IsDone() const { return handle.promise().waiter.load(std::memory_order_acquire) == PromiseBase::Done(); }
+
+        bool await_ready() const noexcept { return IsDone(); }
+        bool await_suspend(std::coroutine_handle<> h) noexcept {
+            void *expected = nullptr;
+            return handle.promise().waiter.compare_exchange_strong(expected, h.address(), std::memory_order_acq_rel);
+        }
+        T await_resume() {
+            auto &result = handle.promise().result;
+            if (auto e = std::get_if<std::exception_ptr>(&result)) std::rethrow_exception(*e);
+            if constexpr (!std::is_void_v<T>) return std::move(std::get<1>(result));
+        }
+
+        // blocks this thread; do not use when the task resumes on this thread, e.g. through an AsyncRunLoop it runs
+        T Wait() {
+            auto &waiter = handle.promise().waiter;
+            for (void *w = waiter.load(); w != PromiseBase::Done(); w = waiter.load()) waiter.wait(w);
+            return await_resume();
+        }
+    };
+
+    /**
+     * Single-threaded executor for tests, benches and tools: hand Poster() to
+     * AsyncDatabase::Options::post and coroutines resume inside Run, on the
+     * thread that calls it, much as they would on an asio io_context.
+     */
+    class AsyncRunLoop {
+        std::deque<std::function<void()>> queue;
+        std::mutex mtx;
+        std::condition_variable cv;
+
+    public:
+        void Post(std::function<void()> fn);
+        std::function<void(std::function<void()>)> Poster() {
+            return [this](std::function<void()> fn) { Post(std::move(fn)); };
+        }
+        bool RunOne();  // runs one queued function, if any, without waiting
+        void RunUntil(const std::function<bool()> &done);  // runs queued functions, waiting for more, until done() is true
+        template<typename T> T Run(AsyncTask<T> &task) {
+            RunUntil([&task] { return task.IsDone(); });
+            return task.await_resume();
+        }
+    };
+}  // namespace DB
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DB {
+    /**
+     * Structured audit trail written as JSON lines to its own file.
+     *
+     * Write only copies the record into a queue; a background thread takes the
+     * whole queue at once, formats it into one buffer, appends it with a single
+     * write and fsyncs according to SyncPolicy. Install with
+     * Logger::setAuditSink so LOG_AUDIT goes here instead of the text log.
+     *
+     * {"ts":1700000000123456,"action":"commit","entity":"sale","entity_id":42,"user_id":7,"request_id":"...","details":"..."}
+     */
+    class AuditSink {
+    public:
+        enum class SyncPolicy {
+            None,        // leave it to the OS
+            EveryBatch,  // fsync after each batch; Flush() returns once records are durable
+            Interval     // fsync at most every syncInterval
+        };
+
+        struct Options {
+            std::string fileName;
+            size_t batchSize = 512;                   // wake the writer once this many records are queued
+            std::chrono::milliseconds flushInterval {100};  // otherwise write whatever is queued this often
+            SyncPolicy sync = SyncPolicy::Interval;
+            std::chrono::milliseconds syncInterval {1000};
+            size_t queueLimit = 65536;  // Write blocks while the queue is this full
+        };
+
+        struct Stats {
+            std::atomic<int64_t> records {0};
+            std::atomic<int64_t> batches {0};
+            std::atomic<int64_t> syncs {0};
+            std::atomic<int64_t> bytes {0};
+            std::atomic<int64_t> blockedWrites {0};  // Write calls that waited for queue room
+            std::atomic<int64_t> errors {0};         // failed write, flush, fsync or close calls; each is also logged
+            std::atomic<int64_t> lostRecords {0};    // records in batches whose write or flush failed
+        };
+
+    private:
+        struct Record {
+            int64_t timeMicros;
+            int entityId;
+            int userId;
+            std::string action, entity, details, requestId;
+        };
+
+        Options options;
+        Stats stats;
+        std::FILE *file {nullptr};
+        std::vector<Record> queue, writing;
+        std::string buffer;
+        std::mutex mtx;
+        std::condition_variable cvWork, cvRoom, cvDone;
+        int64_t enqueued {0}, completed {0};
+        bool stopping {false};
+        int64_t flushTicket {0}, flushServed {0};
+        std::chrono::steady_clock::time_point lastSync;
+        std::thread worker;
+
+        void Run();
+        void WriteBatch(bool forceSync);
+        void Failed(const char *what);
+
+    public:
+        explicit AuditSink(const Options &options);  // throws std::runtime_error when the file cannot be opened
+        ~AuditSink();
+        AuditSink(const AuditSink &) = delete;
+        AuditSink &operator=(const AuditSink &) = delete;
+
+        void Write(const std::string &action, const std::string &entity, int entityId, int userId, const std::string &details, const std::string &requestId);
+        void Flush();  // waits until everything written so far is in the file (and synced, unless SyncPolicy::None)
+        const Stats &GetStats() const { return stats; }
+    };
+}  // namespace DB
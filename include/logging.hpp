@@ -3,11 +3,20 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <fmt/format.h>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <vector>
+
+namespace spdlog::details {
+    class thread_pool;
+}
 
 namespace  DB {
+    class AuditSink;
 
     /**
      * Centralized logging utility
@@ -15,8 +24,31 @@ namespace  DB {
      */
     class Logger {
     public:
+        enum class OverflowPolicy {
+            Block,      // caller waits for room in the queue
+            DropNewest, // the new message is discarded (spdlog >= 1.13, otherwise falls back to DropOldest)
+            DropOldest  // the oldest queued message is overwritten
+        };
+
+        struct AsyncOptions {
+            size_t queueSize = 8192;  // messages held by the ring buffer
+            size_t threads = 1;       // background writers
+            OverflowPolicy overflow = OverflowPolicy::Block;
+            bool console = true;
+            std::string fileName;  // rotating file sink when not empty
+            size_t maxFileSize = 10 * 1024 * 1024;
+            size_t maxFiles = 5;
+            std::chrono::seconds flushInterval {1};  // background flush; warnings and errors flush at once
+        };
+
         static void initialize(const std::string& serviceName, const std::string& logLevel = "info");
+        // LOG_* only enqueue; formatting and sink I/O run on the background thread(s); replaces a logger already registered under serviceName
+        static void initializeAsync(const std::string& serviceName, const std::string& logLevel, const AsyncOptions& options);
+        static void shutdown();                  // drains the async queue and stops its threads; loggers are kept, so threads still logging are safe
+        static uint64_t droppedMessages();       // discarded or overwritten because the queue was full
+        static size_t queuedMessages();          // waiting in the async queue right now
         static std::shared_ptr<spdlog::logger> get(const std::string& name = "default");
+        static spdlog::logger* defaultLogger() { return defaultLogger_.load(std::memory_order_acquire); }  // no refcount traffic; for the LOG_* macros
 
         // Request correlation ID for tracing across services
         static void setRequestId(const std::string& requestId);
@@ -30,42 +62,47 @@ namespace  DB {
 
         // Audit logging for sensitive operations
         static void logAudit(const std::string& action, const std::string& entity, int entityId, int userId, const std::string& details = "");
+        static void setAuditSink(std::shared_ptr<AuditSink> sink);  // safe while other threads log; nullptr: back to the text log
 
     private:
-        static std::shared_ptr<spdlog::logger> defaultLogger_;
+        static void install(std::shared_ptr<spdlog::logger> logger);
+
+        // every logger ever installed stays in installedLoggers_, so a LOG_* call racing shutdown() or initialize*() never touches a freed one
+        static std::atomic<spdlog::logger*> defaultLogger_;
+        static std::atomic<std::shared_ptr<spdlog::logger>> sharedLogger_;  // the same logger, owned, for get()
+        static std::vector<std::shared_ptr<spdlog::logger>> installedLoggers_;
+        static std::shared_ptr<spdlog::details::thread_pool> asyncPool_;
         static thread_local std::string requestId_;
+        static std::atomic<std::shared_ptr<AuditSink>> auditSink_;
     };
 
 }
 
-// Template logging functions that use fmt::runtime for all format strings
-template<typename... Args> 
-inline void LOG_INFO(const std::string& format, Args&&... args) {
-    if (auto logger = DB::Logger::get()) {
-        logger->info(fmt::runtime(format), std::forward<Args>(args)...);
+namespace DB::detail {
+    // format string checked at compile time; a runtime format needs LOG_INFO(fmt::runtime(s), args...)
+    template<typename... Args> inline void Log(spdlog::logger* logger, spdlog::level::level_enum level, fmt::format_string<Args...> format, Args&&... args) {
+        logger->log(level, format, std::forward<Args>(args)...);
     }
-}
 
-template<typename... Args> 
-inline void LOG_ERROR(const std::string& format, Args&&... args) {
-    if (auto logger = DB::Logger::get()) {
-        logger->error(fmt::runtime(format), std::forward<Args>(args)...);
+    // a ready-made message (std::string, string_view, ...) is written as is, braces and all
+    template<typename S>
+        requires(std::is_convertible_v<const S&, std::string_view> && !std::is_array_v<S>)
+    inline void Log(spdlog::logger* logger, spdlog::level::level_enum level, const S& message) {
+        logger->log(level, spdlog::string_view_t(std::string_view(message)));
     }
 }
 
-template<typename... Args> 
-inline void LOG_WARN(const std::string& format, Args&&... args) {
-    if (auto logger = DB::Logger::get()) {
-        logger->warn(fmt::runtime(format), std::forward<Args>(args)...);
-    }
-}
+// The level is tested before the arguments are evaluated, so a disabled LOG_DEBUG costs a load and a compare.
+#define WPSQL_LOG(level, ...)                                                                                     \
+    do {                                                                                                          \
+        if (auto wpsql_logger_ = DB::Logger::defaultLogger(); wpsql_logger_ && wpsql_logger_->should_log(level)) \
+            DB::detail::Log(wpsql_logger_, level, __VA_ARGS__);                                                   \
+    } while (0)
 
-template<typename... Args> 
-inline void LOG_DEBUG(const std::string& format, Args&&... args) {
-    if (auto logger = DB::Logger::get()) {
-        logger->debug(fmt::runtime(format), std::forward<Args>(args)...);
-    }
-}
+#define LOG_INFO(...) WPSQL_LOG(spdlog::level::info, __VA_ARGS__)
+#define LOG_ERROR(...) WPSQL_LOG(spdlog::level::err, __VA_ARGS__)
+#define LOG_WARN(...) WPSQL_LOG(spdlog::level::warn, __VA_ARGS__)
+#define LOG_DEBUG(...) WPSQL_LOG(spdlog::level::debug, __VA_ARGS__)
 
 // LOG_AUDIT function with proper signature
 inline void LOG_AUDIT(const std::string& action, const std::string& entity, int entityId, int userId, const std::string& details = "") {
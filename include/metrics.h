@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace DB {
+    /**
+     * Process-wide metrics registry.
+     *
+     * Every thread that records a metric gets its own block of slots, so the
+     * hot path is a plain load/store on memory no other thread writes - no
+     * locked instructions and no shared cache lines. Readers sum the live
+     * blocks plus whatever exited threads left behind. Registration takes a
+     * mutex and is meant for startup; recording never does.
+     *
+     * Histograms use power-of-two buckets from 1us (2^10 ns) to ~69s (2^36 ns).
+     * Query latency reads the clock for one statement in querySampleEvery per
+     * thread and records it with that weight, so _count and _sum stay unbiased
+     * while the clock cost is spread thin.
+     *
+     *   MetricsRegistry::WritePrometheus([&](std::string_view s) { response.append(s); });
+     */
+    class MetricsRegistry {
+    public:
+        static constexpr int maxSlots = 1024;
+        static constexpr int firstBucketShift = 10;
+        static constexpr int nBuckets = 28;  // the last one is +Inf
+
+        class Counter {
+            int slot;
+
+        public:
+            constexpr explicit Counter(int s) : slot(s) {}
+            void Add(uint64_t n = 1) const {
+                if (IsEnabled()) Bump(slot, n);
+            }
+            uint64_t Value() const;
+        };
+
+        class Histogram {
+            int slot;  // nBuckets bucket slots followed by the sum in nanoseconds
+
+        public:
+            constexpr explicit Histogram(int s) : slot(s) {}
+            void Observe(int64_t nanos, uint64_t weight = 1) const {
+                if (!IsEnabled()) return;
+                uint64_t v = nanos > 0 ? static_cast<uint64_t>(nanos) : 0;
+                int bucket = v <= (uint64_t(1) << firstBucketShift) ? 0 : std::bit_width(v - 1) - firstBucketShift;
+                Bump(slot + (bucket < nBuckets - 1 ? bucket : nBuckets - 1), weight);
+                Bump(slot + nBuckets, v * weight);
+            }
+            void Observe(std::chrono::steady_clock::duration d, uint64_t weight = 1) const { Observe(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count(), weight); }
+            uint64_t Count() const;
+            double SumSeconds() const;
+        };
+
+        // observes the lifetime of the scope for one in sampleEvery scopes on this thread
+        class ScopedTimer {
+            Histogram histogram;
+            uint32_t weight {0};
+            std::chrono::steady_clock::time_point start;
+
+        public:
+            explicit ScopedTimer(Histogram h, uint32_t sampleEvery = 1) : histogram(h) {
+                if (!IsEnabled()) return;
+                if (sampleEvery > 1) {
+                    if (sampleCountdown > 1) {
+                        sampleCountdown--;
+                        return;
+                    }
+                    sampleCountdown = sampleEvery;
+                }
+                weight = sampleEvery ? sampleEvery : 1;
+                start = std::chrono::steady_clock::now();
+            }
+            ~ScopedTimer() {
+                if (weight) histogram.Observe(std::chrono::steady_clock::now() - start, weight);
+            }
+            ScopedTimer(const ScopedTimer &) = delete;
+            ScopedTimer &operator=(const ScopedTimer &) = delete;
+        };
+
+        // names follow prometheus conventions: counters end in _total, histograms in their base unit
+        static Counter AddCounter(const std::string &name, const std::string &help);
+        static Histogram AddHistogram(const std::string &name, const std::string &help);
+
+        static void WritePrometheus(const std::function<void(std::string_view)> &writer);
+        static std::string ToPrometheus();
+
+        static void SetEnabled(bool enabled) { enabledFlag.store(enabled, std::memory_order_relaxed); }
+        static bool IsEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+        static void SetQueryLatencySampling(uint32_t everyN) { querySampleEvery.store(everyN ? everyN : 1, std::memory_order_relaxed); }
+        static uint32_t QueryLatencySampling() { return querySampleEvery.load(std::memory_order_relaxed); }
+
+        // library metrics live in fixed slots so recording them needs no lookup
+        static constexpr Counter Prepares() { return Counter(0); }
+        static constexpr Counter StatementCacheHits() { return Counter(1); }
+        static constexpr Counter RowsStepped() { return Counter(2); }
+        static constexpr Counter BytesBound() { return Counter(3); }
+        static constexpr Counter BusyWaits() { return Counter(4); }
+        static constexpr Counter BackupBytes() { return Counter(5); }
+        static constexpr Histogram QueryLatency() { return Histogram(6); }
+        static constexpr Histogram CommitLatency() { return Histogram(6 + (nBuckets + 1)); }
+        static constexpr Histogram TransactionDuration() { return Histogram(6 + 2 * (nBuckets + 1)); }
+        static constexpr Histogram CheckpointDuration() { return Histogram(6 + 3 * (nBuckets + 1)); }
+        static constexpr int librarySlots = 6 + 4 * (nBuckets + 1);
+
+    private:
+        static inline std::atomic<bool> enabledFlag {true};
+        static inline std::atomic<uint32_t> querySampleEvery {64};
+        static inline thread_local std::atomic<uint64_t> *localSlots {nullptr};
+        static inline thread_local uint32_t sampleCountdown {0};
+
+        static std::atomic<uint64_t> *AttachThread();
+
+        // only the owning thread writes its block, so increments need no read-modify-write instruction
+        static void Bump(int slot, uint64_t n) {
+            auto slots = localSlots;
+            if (!slots) slots = AttachThread();
+            slots[slot].store(slots[slot].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+}
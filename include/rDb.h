@@ -4,7 +4,9 @@
 #include <boost/range/join.hpp>
 #include <boost/tokenizer.hpp>
 #include <string>
+#include <optional>
 #include "wpSQLDatabase.h"
+#include "walCheckpoint.h"
 #include "logging.hpp"
 
 using ConvertFunction = std::function<std::string(int, const std::string &)>;
@@ -34,6 +36,21 @@ namespace DB {
 
     enum ObjectType { EOT, Table, Function, Procedure, View, Index, Command, Constraint, Trigger };
 
+    enum class TuningProfile { Default, OLTP, BulkLoad, ReadOnlyAnalytics, LowMemory };
+
+    // per-connection pragmas applied by SQLiteBase::Open and SetTuningProfile
+    struct TuningSettings {
+        int64_t mmapSize;       // bytes; 0 = no memory mapped I/O
+        int64_t cacheSize;      // pragma cache_size: negative = KiB, positive = pages
+        int tempStore;          // 0 = compile default, 1 = file, 2 = memory
+        int pageSize;           // only honoured when the database is created; 0 = sqlite default
+        int walAutoCheckpoint;  // pages; 0 = never checkpoint automatically
+        bool cacheSpill;        // false keeps dirty pages in the cache until commit
+
+        static TuningSettings For(TuningProfile profile);
+        static std::string Name(TuningProfile profile);
+    };
+
     struct DBObjects {
         std::string objectName;
         ObjectType objectType;
@@ -77,6 +94,7 @@ namespace DB {
         bool exclusiveMode;
         bool usingWAL;
         bool journalOff;
+        TuningProfile tuningProfile {TuningProfile::Default};
         std::shared_ptr<UserDBRegistry> userDBregistry;
         std::string logMessage;
 
@@ -89,10 +107,13 @@ namespace DB {
         std::string _dbName;
         std::string _pathName;
         std::string mainDBname;
+        std::string _vfsName;  // empty = sqlite default vfs
         bool isAggregatedDB;
         OpenMode openMode {OpenMode::ReadOnly};
 
         std::shared_ptr<wpSQLDatabase> db;
+        std::unique_ptr<WalCheckpointer> walCheckpointer;
+        std::optional<WalCheckpointer::Options> walCheckpointerOptions;  // restarts the checkpointer when Open follows a Close
         bool dropAllObjects;
         bool isNewDatabase;
         virtual std::vector<DB::DBObjects> objectList() const ;
@@ -100,6 +121,7 @@ namespace DB {
     private:
         void CreateObject(const std::string &f, const DB::ObjectType ty, const std::vector<std::string> crSQL, bool dropIfExist = false, const std::string &replMaster = "", const std::string &replSibling = "");
         void CreateAllObjects(bool checkAndCreate, bool toExecuteCommand);
+        void ApplyTuning(bool isNew);
 
     public:
         SQLiteBase();
@@ -116,6 +138,13 @@ namespace DB {
         bool IsNewDatabase() { return isNewDatabase; }
         virtual void Close();
         void SetExclusiveMode() { exclusiveMode = true; }
+        void SetTuningProfile(TuningProfile profile);  // applied immediately when already opened
+        TuningProfile GetTuningProfile() const { return tuningProfile; }
+        void StartWalCheckpointer() { StartWalCheckpointer(WalCheckpointer::Options()); }
+        void StartWalCheckpointer(const WalCheckpointer::Options &options);  // after Open; takes over from wal_autocheckpoint
+        void StopWalCheckpointer();  // Close stops it too, but Open then starts it again
+        const WalCheckpointer *GetWalCheckpointer() const { return walCheckpointer.get(); }
+        virtual TuningSettings GetTuningSettings() const { return TuningSettings::For(tuningProfile); }
         void SetUser(const std::string &, const std::string &);
         void ReCreateObjects() { dropAllObjects = true; }
         void SetRelatedDB(const std::string &master, const std::string &sibling) {
@@ -126,6 +155,7 @@ namespace DB {
         void TruncateAllTables();
         void DropAllTables();
         bool BackupDB(int noOfBackupToKeep, std::string folderName, std::function<bool()> fnIsStopping) const;
+        bool RestoreDB(const std::string &zipFileName, std::function<bool()> fnIsStopping = nullptr);  // no other connection to the db files may be open
 
         wpSQLDatabase &GetSession() { return *db.get(); }
         std::shared_ptr<wpSQLDatabase> Get() { return db; }
@@ -152,6 +182,8 @@ namespace DB {
         virtual std::shared_ptr<TransactionDB> GetTransactionDB();
         const std::string GetDBPath() const { return _pathName; }
         void SetDBName(const std::string &n) { _dbName = n; }
+        void SetVFS(const std::string &vfsName) { _vfsName = vfsName; }  // eg. wpSQLCompressedVFS::name; set before Open
+        const std::string GetVFS() const { return _vfsName; }
         virtual bool IsDataBaseExist(const std::string &s, bool toCreate = false);
 
         bool IsTriggerExist(const std::string &fnName) { return IsTriggerExist(GetSession(), fnName); }
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <chrono>
 #include <random>
 #include <array>
+#include <atomic>
+#include <span>
+#include <vector>
 #include <algorithm>
 #include <stdexcept>
 #include <cctype>
 #include <iostream>
 #include <iomanip>
 #include <cstring>
+#include <cstdint>
 #include <unordered_set>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 /**
  * ULID class with internal binary storage for optimal database performance
@@ -31,6 +39,8 @@
 class ULID {
 public:
     static constexpr size_t LENGTH = 16;
+    static constexpr size_t STRING_LENGTH = 26;
+    static constexpr size_t HEX_LENGTH = 32;
 
 private:
     static const uint8_t* to_binary(const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); }
@@ -53,12 +63,18 @@ private:
     public:
         ULIDGenerator() : gen(rd()), dis(0, UINT64_MAX) {}
         std::array<uint8_t, LENGTH> generate() const;
+        void generate(ULID* out, size_t n) const;  // one clock read for the whole batch
 
     private:
         void generateRandomness(std::array<uint8_t, LENGTH>& ulid_bytes, const std::chrono::system_clock::time_point& now) const;
         void incrementRandomness() const;
+        void freshRandomness() const;
+        void generateProcessMonotonic(ULID* out, size_t n, uint64_t timestamp) const;
     } generator;
 
+    static std::atomic<bool> process_monotonic;
+    static std::atomic<uint64_t> process_sequence;  // (timestamp_ms << 16) | sequence of the last id handed out
+
 public:
     ULID() : binary_data(generator.generate()) {}
     explicit ULID(const std::string& ulid_string, bool isBinary = true);
@@ -67,6 +83,8 @@ public:
     ULID(const ULID& other) = default;
     ULID& operator=(const ULID& other) = default;
     std::string toString() const;
+    void encode(char* out) const;     // writes STRING_LENGTH chars, no terminator
+    void encodeHex(char* out) const;  // writes HEX_LENGTH chars, no terminator
     std::string toBinary() const { return std::string(reinterpret_cast<const char*>(data()), size()); }
     const uint8_t* data() const { return binary_data.data(); }
     // const mysqlx::bytes getBytes() const { return { reinterpret_cast<const mysqlx::byte *>(binary_data.data()), LENGTH }; }
@@ -92,9 +110,24 @@ public:
     bool operator>=(const ULID& other) const { return binary_data >= other.binary_data; }
 
     static ULID generate() { return ULID(); }
+    static void generateBatch(std::span<ULID> out) { generator.generate(out.data(), out.size()); }
+    static std::vector<ULID> generateBatch(size_t n);
+
+    // Process-wide monotonic mode: ids from every thread sort in generation order.
+    // Bytes 6-7 then hold a shared per-millisecond sequence (65536 ids/ms before the
+    // timestamp is borrowed from the next millisecond) and bytes 8-15 stay random.
+    static void setProcessMonotonic(bool on) { process_monotonic.store(on, std::memory_order_relaxed); }
+    static bool isProcessMonotonic() { return process_monotonic.load(std::memory_order_relaxed); }
     static ULID generate(uint64_t timestamp_ms);
     static ULID fromHex(const std::string& hex_string);
     static bool isValidString(const std::string& ulid_string);
+    static bool decode(std::string_view s, ULID& out);     // Base32; false on bad length or character
+    static bool decodeHex(std::string_view s, ULID& out);  // false on bad length or character
+
+    // Bulk encoders: write every id into one buffer, each followed by delimiter unless it is '\0'.
+    // The buffer needs ids.size() * (STRING_LENGTH or HEX_LENGTH, +1 with a delimiter); returns the end.
+    static char* encodeBatch(std::span<const ULID> ids, char* out, char delimiter = '\0');
+    static char* encodeHexBatch(std::span<const ULID> ids, char* out, char delimiter = '\0');
 };
 
 std::string toString(std::unordered_set<ULID>);
@@ -105,12 +138,32 @@ std::istream& operator>>(std::istream& is, ULID& ulid);
 // Hash support for std::unordered_map, std::unordered_set
 namespace std {
     template<> struct hash<ULID> {
+        // wyhash-style mix: 64x64->128 multiply, then xor of the two halves
+        static uint64_t mum(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+            __uint128_t r = static_cast<__uint128_t>(a) * b;
+            return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            uint64_t hi;
+            uint64_t lo = _umul128(a, b, &hi);
+            return lo ^ hi;
+#else
+            uint64_t ha = a >> 32, la = a & 0xffffffffULL, hb = b >> 32, lb = b & 0xffffffffULL;
+            uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            uint64_t t = rl + (rm0 << 32), c = t < rl;
+            uint64_t lo = t + (rm1 << 32);
+            c += lo < t;
+            uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+            return lo ^ hi;
+#endif
+        }
+
         size_t operator()(const ULID& ulid) const {
-            // Use first 8 bytes as hash (sufficient for most use cases)
-            const uint8_t* data = ulid.data();
-            size_t result = 0;
-            for (int i = 0; i < 8; ++i) { result = (result << 8) | data[i]; }
-            return result;
+            // all 16 bytes: the leading 6 are the millisecond timestamp, so ids from one burst differ only in the tail
+            uint64_t lo, hi;
+            std::memcpy(&hi, ulid.data(), 8);
+            std::memcpy(&lo, ulid.data() + 8, 8);
+            return static_cast<size_t>(mum(hi ^ 0xa0761d6478bd642fULL, lo ^ 0xe7037ed1a0b428dbULL) ^ mum(hi, 0x8ebc6af09c88c6e3ULL));
         }
     };
-}
\ No newline at end of file
+}
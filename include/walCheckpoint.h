@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "wpSQLDatabase.h"
+
+namespace DB {
+    /**
+     * Background WAL checkpointer for one database file.
+     *
+     * Runs on its own connection and thread. Every interval it does a PASSIVE
+     * checkpoint. Once the WAL is fully copied back and larger than
+     * escalateBytes it tries a TRUNCATE without waiting; that only succeeds
+     * when no reader still uses the WAL. When the frames still in the WAL go
+     * over capBytes it does a TRUNCATE that waits up to capWaitMs for the
+     * writer and readers, so the WAL cannot grow without limit under
+     * sustained writes.
+     */
+    class WalCheckpointer {
+    public:
+        struct Options {
+            std::chrono::milliseconds interval {1000};
+            int64_t escalateBytes {16LL << 20};  // wal file size above which a non-blocking TRUNCATE is tried
+            int64_t capBytes {256LL << 20};      // wal content above which a blocking TRUNCATE is forced
+            int capWaitMs {2000};                // how long the forced checkpoint waits for locks
+        };
+
+        struct Metrics {
+            std::atomic<int64_t> walBytes {0};  // size of the -wal file after the last run
+            std::atomic<int64_t> walFrames {0};
+            std::atomic<int64_t> framesCheckpointed {0};
+            std::atomic<int64_t> passiveCount {0};
+            std::atomic<int64_t> truncateCount {0};
+            std::atomic<int64_t> forcedCount {0};
+            std::atomic<int64_t> busyCount {0};
+            std::atomic<int64_t> errorCount {0};
+            std::atomic<int64_t> lastDurationMicros {0};
+            std::atomic<int64_t> maxDurationMicros {0};
+            std::atomic<int64_t> totalDurationMicros {0};
+        };
+
+    private:
+        std::string dbName;
+        std::string vfsName;
+        Options options;
+        Metrics metrics;
+        wpSQLDatabase db;
+        std::thread worker;
+        std::mutex mtx;
+        std::mutex runMtx;  // one checkpoint round at a time on db: the worker's and RunOnce's
+        std::condition_variable cv;
+        bool stopping {false};
+        int64_t frameBytes {4096 + 24};
+        std::chrono::steady_clock::time_point busyDeadline;
+
+        static int BusyHandler(void *self, int nCalled);
+        int Checkpoint(int mode, int busyWaitMs, int &nLog, int &nCheckpointed);
+        void Run();
+
+    public:
+        WalCheckpointer(const std::string &dbName, const Options &options, const std::string &vfsName = "");
+        explicit WalCheckpointer(const std::string &dbName) : WalCheckpointer(dbName, Options()) {}
+        ~WalCheckpointer() { Stop(); }
+        WalCheckpointer(const WalCheckpointer &) = delete;
+        WalCheckpointer &operator=(const WalCheckpointer &) = delete;
+
+        void Start();
+        void Stop();
+        bool IsRunning() const { return worker.joinable(); }
+        void RunOnce();  // one checkpoint round on the caller's thread; waits for a round the worker is running
+        int64_t GetWalSize() const;
+        const Metrics &GetMetrics() const { return metrics; }
+        const Options &GetOptions() const { return options; }
+    };
+}  // namespace DB
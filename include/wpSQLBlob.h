@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "wpSQLDatabase.h"
+
+/**
+ * Incremental I/O on one blob cell through sqlite3_blob_open/read/write/reopen,
+ * so large receipts and images move in fixed-size chunks instead of whole
+ * copies. A blob handle can't change the size of its cell: reserve the space
+ * first with wpSQLStatement::BindZeroBlob, then write into it.
+ *
+ *   insert->BindZeroBlob(2, fileSize);
+ *   insert->ExecuteUpdate();
+ *   auto blob = db.OpenBlob("receipts", "image", db.GetLastRowId(), true);
+ *   blob->CopyFrom(file);
+ *   ...
+ *   db.OpenBlob("receipts", "image", id)->CopyTo(*zip.Add_File("receipt.jpg"));
+ */
+class wpSQLBlob {
+    std::shared_ptr<wpSQLManager> db;
+    sqlite3_blob *blob {nullptr};
+    int size {0};
+
+public:
+    static constexpr int defaultChunkSize = 64 * 1024;
+
+    wpSQLBlob(std::shared_ptr<wpSQLManager> d, const std::string &table, const std::string &column, int64_t rowid, bool writable = false, const std::string &database = "main");
+    wpSQLBlob(const wpSQLBlob &) = delete;
+    wpSQLBlob &operator=(const wpSQLBlob &) = delete;
+    ~wpSQLBlob();
+
+    int Size() const { return size; }
+    void Read(void *buffer, int n, int offset) const;
+    void Write(const void *data, int n, int offset);
+    void Reopen(int64_t rowid);  // same table and column, another row; cheaper than a new handle
+
+    // whole-blob transfers in chunkSize pieces; the caller never holds more than one chunk; chunkSize <= 0 throws SQLITE_MISUSE
+    void ForEachChunk(const std::function<void(std::span<const unsigned char>)> &fn, int chunkSize = defaultChunkSize) const;
+    int64_t CopyTo(std::ostream &out, int chunkSize = defaultChunkSize) const;
+    int64_t CopyFrom(std::istream &in, int chunkSize = defaultChunkSize);  // stops at Size() or the end of in
+};
+
+// std::streambuf over an open blob; reads and writes share one chunk buffer and never go past Size()
+class wpSQLBlobBuf : public std::streambuf {
+    std::shared_ptr<wpSQLBlob> blob;
+    std::vector<char> buffer;
+    int64_t offset {0};  // blob position of buffer[0]
+
+    bool FlushPut();
+    int64_t Tell() const;
+
+protected:
+    int_type underflow() override;
+    int_type overflow(int_type c) override;
+    int sync() override { return FlushPut() ? 0 : -1; }
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override { return seekoff(off_type(pos), std::ios_base::beg, which); }
+
+public:
+    explicit wpSQLBlobBuf(std::shared_ptr<wpSQLBlob> b, int chunkSize = wpSQLBlob::defaultChunkSize);  // throws SQLITE_MISUSE when chunkSize <= 0
+    ~wpSQLBlobBuf() override;
+};
+
+class wpSQLBlobStream : public std::iostream {
+    wpSQLBlobBuf buf;
+
+public:
+    explicit wpSQLBlobStream(std::shared_ptr<wpSQLBlob> b, int chunkSize = wpSQLBlob::defaultChunkSize) : std::iostream(nullptr), buf(std::move(b), chunkSize) { rdbuf(&buf); }
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "sqlite3.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Page-compressing SQLite VFS shim layered over the default VFS.
+ *
+ * Main database files opened through it keep every page deflated in its own
+ * slot of the underlying file; journals and temp files pass through untouched.
+ * A page map (page number -> slot) is rebuilt from the slot headers when the
+ * file is opened, and decompressed pages are kept in a per-connection LRU cache.
+ *
+ * Usage:
+ *   db.Open("master.db", OpenMode::ReadWrite, wpSQLCompressedVFS::name);
+ *   db.Open("file:master.db?vfs=wpzip");
+ *
+ * Limitations: rollback journal only (no shared memory, so journal_mode=WAL is
+ * ignored unless locking_mode=EXCLUSIVE is set first; SQLiteBase logs a warning
+ * and stays in the rollback journal), no memory-mapped I/O, page size fixed at
+ * creation.
+ */
+class wpSQLCompressedVFS {
+public:
+    static constexpr auto name = "wpzip";
+
+    struct Options {
+        int cachePages = 2000;  // decompressed pages kept per connection
+        int compressionLevel = 6;
+    };
+
+    struct Stats {
+        std::atomic<int64_t> pagesRead {0};
+        std::atomic<int64_t> pagesWritten {0};
+        std::atomic<int64_t> cacheHits {0};
+        std::atomic<int64_t> bytesBeforeCompression {0};
+        std::atomic<int64_t> bytesAfterCompression {0};
+        std::atomic<int64_t> damagedSlots {0};  // slot headers skipped while opening, e.g. after a torn write
+    };
+
+    static int Register() { return Register(Options(), false); }
+    static int Register(const Options &options, bool makeDefault = false);  // idempotent; only the first call's options apply
+    static Stats &GetStats();
+};
@@ -14,7 +14,13 @@
 #include <iomanip>
 #include <charconv>
 #include <stdexcept>
+#include <algorithm>
+#include <tuple>
+#include <list>
+#include <span>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <codecvt>
 #include <locale>
 #include <boost/algorithm/string.hpp>
@@ -27,6 +33,11 @@
 #include <boost/uuid/uuid_io.hpp>
 #include "timefunctions.h"
 #include "ulid.hpp"
+#include "metrics.h"
+#include "wpSQLStringArena.h"
+#include "wpUTF.h"
+#include "wpSQLProfiler.h"
+#include "wpSQLQueryAdvisor.h"
 
 constexpr auto wpDATEFORMAT = "%d-%m-%Y";
 constexpr auto wpDATEFORMATLONG = "%a %d-%b-%Y";
@@ -42,7 +53,7 @@ typedef std::chrono::system_clock::time_point TimePoint;
 
 template<typename T> std::wstring to_wstring(const T &v) {
     if constexpr (std::is_same_v<T, std::string>)
-        return boost::locale::conv::utf_to_utf<wchar_t>(v);
+        return wpUTF::ToWide(v);
     else if constexpr (std::is_same_v<T, std::wstring>)
         return v;
     else if constexpr (std::is_same_v<T, char *>)
@@ -57,7 +68,7 @@ template<typename T> std::string to_string(const T &v) {
     if constexpr (std::is_same_v<T, std::string>)
         return v;
     else if constexpr (std::is_same_v<T, std::wstring>)
-        return boost::locale::conv::utf_to_utf<char>(v);
+        return wpUTF::ToUTF8(v);
     else if constexpr (std::is_same_v<T, const char *>)
         return std::string(v);
     else if constexpr (std::is_same_v<T, char *>)
@@ -188,50 +199,126 @@ public:
     wpSQLException(const std::string m, int rc_, sqlite3 *db);
 };
 
+// name lookups for one prepared statement; the statement cache keeps it with the statement, so a cache
+// hit reuses it, and each table is rebuilt when sqlite reprepares the statement after a schema change
+class wpSQLStatementIndex {
+    // open-addressed, power-of-two tables whose lookups allocate nothing; column names match ascii
+    // case-insensitively as sqlite compares them, parameter names exactly as sqlite3_bind_parameter_index does
+    std::vector<std::pair<std::string, int>> columns, params;
+    int columnsPrepare {-1}, paramsPrepare {-1};  // reprepare count each was built at
+
+public:
+    int GetColumnIndex(sqlite3_stmt *stmt, std::string_view name);  // -1 when there is no such column
+    int GetParamIndex(sqlite3_stmt *stmt, std::string_view name);   // 0 when there is no such parameter
+};
+
 class wpSQLManager {
+    struct SqlHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view> {}(s); }
+    };
+
+    struct IdleStatement {
+        sqlite3_stmt *stmt;
+        wpSQLStatementIndex index;
+        const std::string *sql;  // key it is listed under
+    };
+    struct SqlEntry {
+        std::vector<std::list<IdleStatement>::iterator> idle;  // most recently released last
+        int outstanding {0};  // handed out under this key and not released yet; keeps the key alive
+    };
+
+public:
+    using StatementKey = std::pair<const std::string, SqlEntry>;  // what a handed out statement is released under
+
+private:
     sqlite3 *db;
+    std::unique_ptr<wpSQLProfiler> profiler;  // removed before the connection closes
+    std::unique_ptr<wpSQLQueryAdvisor> advisor;
+    // statement cache, keyed by the sql a statement was requested with: sqlite3_sql() drops any tail such as "; "
+    std::unordered_map<std::string, SqlEntry, SqlHash, std::equal_to<>> statements;
+    std::list<IdleStatement> lru, spare;  // idle statements, most recently released first; spare recycles the list nodes
+    size_t idleCount {0};
+    size_t cacheCapacity {0};  // 0 = released statements are finalized
+
+    void EvictOldest();
+    void Forget(StatementKey *key);  // drops a key once nothing is idle or handed out under it
 
 public:
+    std::chrono::steady_clock::time_point txStart;  // set by wpSQLDatabase::Begin while metrics are enabled
+
     wpSQLManager() : db(NULL) {}
     wpSQLManager(sqlite3 *d) : db(d) {}
     ~wpSQLManager();
     sqlite3 *GetSQLite3() { return db; }
+    wpSQLProfiler *GetProfiler() { return profiler.get(); }
+    void SetProfiler(std::unique_ptr<wpSQLProfiler> p) { profiler = std::move(p); }
+    wpSQLQueryAdvisor *GetQueryAdvisor() { return advisor.get(); }
+    void SetQueryAdvisor(std::unique_ptr<wpSQLQueryAdvisor> a) { advisor = std::move(a); }
+
+    // an idle statement for sql or null; index receives its lookups, key what to release it (or a fresh prepare) under
+    sqlite3_stmt *TakeCachedStatement(std::string_view sql, wpSQLStatementIndex &index, StatementKey *&key);
+    // caches or finalizes a statement its owner is done with, evicting the least recently used one when full
+    void ReleaseStatement(StatementKey *key, sqlite3_stmt *stmt, wpSQLStatementIndex &&index);
+    void SetStatementCacheCapacity(size_t capacity);
+    size_t GetStatementCacheCapacity() const { return cacheCapacity; }
+    size_t GetCachedStatementCount() const { return idleCount; }
+    void ClearStatementCache();
 };
 
 class wpSQLStatementManager {
     std::shared_ptr<wpSQLManager> db;
     sqlite3_stmt *stmt;
+    wpSQLManager::StatementKey *key {nullptr};  // cache key it was requested under; null when not cached
+    wpSQLStatementIndex index;  // shared by the statement's binds and every result set of it
 
 public:
     wpSQLStatementManager() : stmt(NULL) {}
-    wpSQLStatementManager(std::shared_ptr<wpSQLManager> d, sqlite3_stmt *s) : db(d), stmt(s) {}
+    wpSQLStatementManager(std::shared_ptr<wpSQLManager> d, sqlite3_stmt *s, wpSQLManager::StatementKey *k = nullptr, wpSQLStatementIndex i = {})
+      : db(d), stmt(s), key(k), index(std::move(i)) {}
+    wpSQLStatementManager(const wpSQLStatementManager &) = delete;
+    wpSQLStatementManager &operator=(const wpSQLStatementManager &) = delete;
     ~wpSQLStatementManager() {
-        if (stmt) { sqlite3_finalize(stmt); }
+        if (stmt) {
+            if (db)
+                db->ReleaseStatement(key, stmt, std::move(index));
+            else
+                sqlite3_finalize(stmt);
+        }
         stmt = NULL;
     }
     sqlite3_stmt *GetStatement() { return stmt; }
     sqlite3 *GetSQLite3() { return db->GetSQLite3(); }
+    int GetColumnIndex(std::string_view name) { return index.GetColumnIndex(stmt, name); }  // -1 when there is no such column
+    int GetParamIndex(std::string_view name) { return index.GetParamIndex(stmt, name); }    // 0 when there is no such parameter
 };
 
 class wpSQLDatabase;
+class wpSQLBlob;
 
 class wpSQLResultSet {
-    std::shared_ptr<wpSQLStatementManager> stmt;
+    std::shared_ptr<wpSQLStatementManager> owner;  // empty when the result set borrows its statement
+    wpSQLStatementManager *stmt;
     bool isEOF, isFirst;
     int nCols;
-    std::string pSQL;
+    mutable std::unique_ptr<wpSQLStringArena> arena;  // created by the first Get<std::string_view>
 
 private:
     wpSQLResultSet();  // - not defined - should not be used;
+    std::string_view Intern(int i) const;
+    int ColumnIndex(std::string_view name) const;  // throws when there is no such column
 public:
     wpSQLResultSet(std::shared_ptr<wpSQLStatementManager> s, bool is_eof = false, bool is_first = true);
+    wpSQLResultSet(wpSQLStatementManager *s, bool is_eof, bool is_first);  // borrows s; see wpSQLStatement::Query
     bool NextRow();
-    std::string GetSQL() { return pSQL; }
+    std::string GetSQL() const;  // expanded with the statement's current bindings
     int GetColumnType(int i) const;
     int GetColumnCount() const { return nCols; }
     std::string GetColumnName(int i) const;
-    int GetColumnIndex(const std::string &name) const;
+    int GetColumnIndex(std::string_view name) const { return stmt->GetColumnIndex(name); }
     bool IsNull(int i) { return GetColumnType(i) == SQLITE_NULL; }
+    bool IsNull(std::string_view name) { return IsNull(ColumnIndex(name)); }
+    const wpSQLStringArena *GetStringArena() const { return arena.get(); }
     const unsigned char *GetBlob(int i, int64_t &len) const {
         if (GetColumnType(i) == SQLITE_NULL) {
             len = 0;
@@ -274,43 +361,63 @@ public:
             return res;
         } else if constexpr (std::is_same_v<T, std::wstring>) {
             if (GetColumnType(i) == SQLITE_NULL) return std::wstring {};
-            return boost::locale::conv::utf_to_utf<wchar_t>(reinterpret_cast<const char *>(sqlite3_column_text(stmt->GetStatement(), i)));
+            if constexpr (sizeof(wchar_t) == 2) {  // utf-16 as sqlite has it, no conversion
+                auto text = static_cast<const wchar_t *>(sqlite3_column_text16(stmt->GetStatement(), i));
+                return std::wstring(text, sqlite3_column_bytes16(stmt->GetStatement(), i) / sizeof(wchar_t));
+            } else {
+                auto text = reinterpret_cast<const char *>(sqlite3_column_text(stmt->GetStatement(), i));
+                return wpUTF::ToWide(std::string_view(text, sqlite3_column_bytes(stmt->GetStatement(), i)));
+            }
         } else if constexpr (std::is_same_v<T, char *>) {
             if (GetColumnType(i) == SQLITE_NULL) return nullptr;
             return reinterpret_cast<char *>(sqlite3_column_text(stmt->GetStatement(), i));
         } else if constexpr (std::is_same_v<T, std::string>) {
             if (GetColumnType(i) == SQLITE_NULL) return defaultValue;
             return boost::locale::conv::utf_to_utf<char>(reinterpret_cast<const char *>(sqlite3_column_text(stmt->GetStatement(), i)));
+        } else if constexpr (std::is_same_v<T, std::string_view>) {  // interned: valid for the life of this result set
+            if (GetColumnType(i) == SQLITE_NULL) return defaultValue;
+            return Intern(i);
         }
         return T {};
     }
+    template<typename T = std::string> T Get(std::string_view name, const T &defaultValue = T {}) const { return Get<T>(ColumnIndex(name), defaultValue); }
 
     bool IsEOF() const { return isEOF; }
 };
 
+// a parameter name as a template argument, checked at compile time: stmt->Bind<"@id">(id)
+template<size_t N> struct wpSQLParamName {
+    char name[N];
+    constexpr wpSQLParamName(const char (&s)[N]) { std::copy_n(s, N, name); }
+    constexpr std::string_view view() const { return {name, N - 1}; }
+};
+
 class wpSQLStatement {
     std::shared_ptr<wpSQLStatementManager> stmt;
     bool needReset;
-    std::string pSQL;
+    std::string convertBuffer;  // reused for wstring binds; sqlite copies out of it
 
 private:
     void Reset();
+    bool Step();  // true when the statement produced a row
     wpSQLStatement();  // not defined - should not be used.
 public:
-    wpSQLStatement(std::shared_ptr<wpSQLStatementManager> s) : stmt(s), needReset(false) { pSQL = sqlite3_sql(stmt->GetStatement()); }
+    wpSQLStatement(std::shared_ptr<wpSQLStatementManager> s) : stmt(s), needReset(false) {}
     int GetParamCount() const { return sqlite3_bind_parameter_count(stmt->GetStatement()); }
-    int GetParamIndex(const std::string &name, bool throwIfError = false) const;
+    int GetParamIndex(std::string_view name, bool throwIfError = false) const;
     std::string GetParamName(int i) const { return sqlite3_bind_parameter_name(stmt->GetStatement(), i); }
-    std::string GetSQL() { return pSQL; }
+    std::string GetSQL() const { return sqlite3_sql(stmt->GetStatement()); }
     std::shared_ptr<wpSQLResultSet> Execute();
     std::shared_ptr<wpSQLResultSet> ExecuteQuery() { return Execute(); }
+    // same as Execute but the result set lives on the caller's stack and borrows this statement: no heap allocation.
+    // It must not outlive the statement, and binding or executing the statement again ends it.
+    wpSQLResultSet Query() { return wpSQLResultSet(stmt.get(), !Step(), true); }
     int ExecuteUpdate();
 
     template<typename T = int64_t> T ExecuteScalar() {
-        needReset = true;
-        std::shared_ptr<wpSQLResultSet> rs = ExecuteQuery();
+        auto rs = Query();
         T value {};
-        while (rs->NextRow()) value += rs->Get<T>(0);
+        while (rs.NextRow()) value += rs.Get<T>(0);
         return value;
     }
 
@@ -335,14 +442,14 @@ public:
             auto iv = get_int_value(val);
             rc = (iv == epochNull_ms) ? sqlite3_bind_null(stmt->GetStatement(), idx) : sqlite3_bind_int64(stmt->GetStatement(), idx, iv);
         } else if constexpr (std::is_same_v<T, boost::uuids::uuid>)
-            rc = sqlite3_bind_blob(stmt->GetStatement(), idx, (const void *)val.data, (int)(val.size()), nullptr);
+            rc = sqlite3_bind_blob(stmt->GetStatement(), idx, (const void *)val.data, (int)(val.size()), SQLITE_TRANSIENT);
         else if constexpr (std::is_same_v<T, char *>)
             rc = sqlite3_bind_text(stmt->GetStatement(), idx, val, -1, SQLITE_TRANSIENT);  // sqlite_transient - sqlite use internal mem
 #ifdef __WX__
         else if constexpr (std::is_same_v<T, wxLongLong>)
             rc = sqlite3_bind_int64(stmt->GetStatement(), idx, val.GetValue());
         else if constexpr (std::is_same_v<T, wxMemoryBuffer>)
-            rc = sqlite3_bind_blob(stmt->GetStatement(), idx, (const void *)val.GetData(), (int)(val.GetDataLen()), nullptr);
+            rc = sqlite3_bind_blob(stmt->GetStatement(), idx, (const void *)val.GetData(), (int)(val.GetDataLen()), SQLITE_TRANSIENT);
         else if constexpr (std::is_same_v<T, wxDateTime>) {
             if (val.IsValid())
                 rc = sqlite3_bind_int64(stmt->GetStatement(), idx, val.GetValue().GetValue());
@@ -355,33 +462,98 @@ public:
 #endif
 
         else if constexpr (std::is_same_v<T, std::string>)
-            rc = sqlite3_bind_text(stmt->GetStatement(), idx, val.c_str(), -1, SQLITE_TRANSIENT);  // sqlite_transient - sqlite use internal mem
+            rc = sqlite3_bind_text64(stmt->GetStatement(), idx, val.data(), val.size(), SQLITE_TRANSIENT, SQLITE_UTF8);  // sqlite_transient - sqlite use internal mem
         else if constexpr (std::is_same_v<T, ULID>) {
             rc = sqlite3_bind_blob(stmt->GetStatement(), idx, (const void *)val.data(), val.size(), SQLITE_TRANSIENT);
         } else if constexpr (std::is_same_v<T, std::pair<const uint8_t*, size_t>>) {
-            rc = sqlite3_bind_blob(stmt->GetStatement(), idx, (const void *)val.first, (int)(val.second), SQLITE_TRANSIENT);
+            rc = sqlite3_bind_blob64(stmt->GetStatement(), idx, (const void *)val.first, val.second, SQLITE_TRANSIENT);
         } else if constexpr (std::is_same_v<T, std::wstring>) {
-            auto converted = to_string(val);
-            rc = sqlite3_bind_text(stmt->GetStatement(), idx, converted.c_str(), -1, SQLITE_TRANSIENT);  // sqlite_transient - sqlite use internal mem
-        } else
-            rc = sqlite3_bind_text(stmt->GetStatement(), idx, val, -1, nullptr);  // nullptr -> sqlite won't copy/delete mem
+            if constexpr (sizeof(wchar_t) == 2)  // already utf-16
+                rc = sqlite3_bind_text64(stmt->GetStatement(), idx, reinterpret_cast<const char *>(val.data()), val.size() * sizeof(wchar_t), SQLITE_TRANSIENT, SQLITE_UTF16);
+            else {
+                convertBuffer.clear();
+                wpUTF::AppendUTF8(val, convertBuffer);
+                rc = sqlite3_bind_text64(stmt->GetStatement(), idx, convertBuffer.data(), convertBuffer.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
+            }
+        } else if constexpr (std::is_convertible_v<const T &, const char *>)
+            rc = sqlite3_bind_text(stmt->GetStatement(), idx, val, -1, SQLITE_TRANSIENT);  // literals and char buffers alike; BindView skips the copy
+        else
+            static_assert(sizeof(T) == 0, "wpSQLStatement::Bind: unsupported type");
         if (rc != SQLITE_OK) throw wpSQLException("cannot bind: ", rc, stmt->GetSQLite3());
+        DB::MetricsRegistry::BytesBound().Add(BoundBytes(val));
+    }
+
+    template<typename T> static uint64_t BoundBytes(const T &val) {
+        if constexpr (std::is_arithmetic_v<T>)
+            return sizeof(T);
+        else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::wstring>)
+            return val.size() * sizeof(typename T::value_type);
+        else if constexpr (std::is_same_v<T, std::pair<const uint8_t *, size_t>>)
+            return val.second;
+        else if constexpr (std::is_convertible_v<const T &, const char *>)
+            return std::char_traits<char>::length(val);
+        else if constexpr (requires { val.size(); })
+            return val.size();
+        else
+            return sizeof(T);
     }
 
-    template<typename T> void Bind(const std::string &paramName, const T &v) { Bind(GetParamIndex(paramName, true), v); }
+    template<typename T> void Bind(std::string_view paramName, const T &v) { Bind(GetParamIndex(paramName, true), v); }
+    template<wpSQLParamName name, typename T> void Bind(const T &v) {
+        static_assert(name.name[0] == '@' || name.name[0] == ':' || name.name[0] == '$', "sqlite parameter names start with @, : or $");
+        Bind(GetParamIndex(name.view(), true), v);
+    }
+
+    // names pair up with the tuple elements in order: stmt->BindTuple({"@id", "@value"}, std::tuple(id, value))
+    template<typename... T> void BindTuple(std::initializer_list<std::string_view> names, const std::tuple<T...> &values) {
+        if (names.size() != sizeof...(T)) throw wpSQLException(fmt::format("wpSQLStatement::BindTuple> {} names for {} values", names.size(), sizeof...(T)), SQLITE_MISUSE, stmt->GetSQLite3());
+        auto name = names.begin();
+        std::apply([&](const auto &...v) { (Bind(GetParamIndex(*name++, true), v), ...); }, values);
+    }
+
+    // S lists its parameters as: static constexpr auto wpSQLParams = std::make_tuple(std::pair {"@id", &S::id}, std::pair {"@name", &S::name});
+    template<typename S> void BindStruct(const S &s) {
+        std::apply([&](const auto &...field) { (Bind(GetParamIndex(field.first, true), s.*(field.second)), ...); }, S::wpSQLParams);
+    }
+
+    // binds without copying (SQLITE_STATIC): the memory must stay valid and unchanged until the parameter is
+    // bound again or the statement is finalized, not just until the next step
+    void BindView(int idx, std::string_view text) {
+        if (needReset) Reset();
+        int rc = sqlite3_bind_text64(stmt->GetStatement(), idx, text.data(), text.size(), SQLITE_STATIC, SQLITE_UTF8);
+        if (rc != SQLITE_OK) throw wpSQLException("cannot bind text view: ", rc, stmt->GetSQLite3());
+        DB::MetricsRegistry::BytesBound().Add(text.size());
+    }
+    void BindView(int idx, std::span<const uint8_t> blob) {
+        if (needReset) Reset();
+        int rc = sqlite3_bind_blob64(stmt->GetStatement(), idx, blob.data(), blob.size(), SQLITE_STATIC);
+        if (rc != SQLITE_OK) throw wpSQLException("cannot bind blob view: ", rc, stmt->GetSQLite3());
+        DB::MetricsRegistry::BytesBound().Add(blob.size());
+    }
+    void BindView(int idx, std::string &&) = delete;  // a temporary would be gone before the step
+    void BindView(std::string_view paramName, std::string_view text) { BindView(GetParamIndex(paramName, true), text); }
+    void BindView(std::string_view paramName, std::span<const uint8_t> blob) { BindView(GetParamIndex(paramName, true), blob); }
 
     void Bind(int idx, const unsigned char *val, int len) {
         if (needReset) Reset();
         int rc = sqlite3_bind_blob(stmt->GetStatement(), idx, (const void *)val, len, SQLITE_TRANSIENT);
         if (rc != SQLITE_OK) throw wpSQLException("cannot bind blob: ", rc, stmt->GetSQLite3());
+        DB::MetricsRegistry::BytesBound().Add(len);
     }
-    void Bind(const std::string &paramName, const unsigned char *blob, int len) { Bind(GetParamIndex(paramName, true), blob, len); }
+    void Bind(std::string_view paramName, const unsigned char *blob, int len) { Bind(GetParamIndex(paramName, true), blob, len); }
     void BindNull(int idx) {
         if (needReset) Reset();
         int rc = sqlite3_bind_null(stmt->GetStatement(), idx);
         if (rc != SQLITE_OK) throw wpSQLException("cannot bind null: ", rc, stmt->GetSQLite3());
     }
-    void BindNull(const std::string &paramName) { BindNull(GetParamIndex(paramName, true)); }
+    void BindNull(std::string_view paramName) { BindNull(GetParamIndex(paramName, true)); }
+    // reserves size zero bytes for a blob that is then filled through wpSQLBlob without holding it in memory
+    void BindZeroBlob(int idx, int64_t size) {
+        if (needReset) Reset();
+        int rc = sqlite3_bind_zeroblob64(stmt->GetStatement(), idx, size);
+        if (rc != SQLITE_OK) throw wpSQLException("cannot bind zeroblob: ", rc, stmt->GetSQLite3());
+    }
+    void BindZeroBlob(std::string_view paramName, int64_t size) { BindZeroBlob(GetParamIndex(paramName, true), size); }
 };
 
 class wpAutoCommitter {
@@ -402,7 +574,8 @@ class wpSQLDatabase {
 
     static int callback(void *fnLambda, int argc, char **argv, char **azColName);
     static void register_function(sqlite3_context *, int argc, sqlite3_value **data);
-    sqlite3_stmt *Prepare(const std::string &sql);
+    std::shared_ptr<wpSQLStatementManager> Prepare(const std::string &sql);
+    void EndTransaction();  // records the transaction duration started by Begin
 
 public:
     wpSQLDatabase() {}
@@ -444,10 +617,29 @@ public:
     int ExecuteUpdate(const std::string &sql) { return Execute(sql, nullptr); }
     std::shared_ptr<wpSQLResultSet> ExecuteQuery(const std::string &sql) { return Execute(sql); }
 
-    void Open(const std::string &fileName, OpenMode mode = OpenMode::ReadWrite);  // 1 minute
+    void Open(const std::string &fileName, OpenMode mode = OpenMode::ReadWrite, const std::string &vfsName = "");  // 1 minute; fileName may be a file: URI
     sqlite3 *GetDB() { return db ? db->GetSQLite3() : NULL; }
     void Close() { db.reset(); }
 
+    // statement profiling on this connection; runs at or above slowQueryThreshold are logged with LOG_WARN
+    void EnableProfiler(std::chrono::milliseconds slowQueryThreshold = std::chrono::milliseconds(500));
+    void DisableProfiler();
+    wpSQLProfiler *GetProfiler() { return db ? db->GetProfiler() : nullptr; }
+    std::string DumpProfile(wpSQLProfiler::SortBy sortBy = wpSQLProfiler::SortBy::TotalTime, size_t limit = 50);
+
+    // EXPLAIN QUERY PLAN on the first prepare of each distinct sql; with persist, findings go to wpSQLQueryAdvisor::tableName on Flush, Disable or Close
+    void EnableQueryAdvisor(bool persist = true);
+    void DisableQueryAdvisor();
+    wpSQLQueryAdvisor *GetQueryAdvisor() { return db ? db->GetQueryAdvisor() : nullptr; }
+
+    // keeps up to capacity released statements, reset, for the next Prepare of the same sql; 0 turns the cache off
+    void EnableStatementCache(size_t capacity = 64);
+    void DisableStatementCache() { EnableStatementCache(0); }
+    size_t GetCachedStatementCount() { return db ? db->GetCachedStatementCount() : 0; }
+
+    // incremental blob I/O on one cell; see wpSQLBlob.h
+    std::shared_ptr<wpSQLBlob> OpenBlob(const std::string &table, const std::string &column, int64_t rowid, bool writable = false, const std::string &database = "main");
+
     bool TableExists(const std::string &tableName, const std::string &databaseName = "");
     void CreateFunction(const std::string &functionName, int nArg, void (*fn)(sqlite3_context *ctx, int argc, sqlite3_value **data), void *data = nullptr, bool isDeterministic = true);
     int BackupTo(const std::string &backupName, std::function<bool()> fnIsStopping, std::function<void(int, int)> fnProgressFeedback = nullptr, int nPagesPerCall = 100, int msSleepPerCall = 250);
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "sqlite3.h"
+
+/**
+ * Per-connection statement profiler built on sqlite3_trace_v2.
+ *
+ * Each finished statement run (SQLITE_TRACE_PROFILE) is folded into an entry
+ * keyed by its normalized SQL - literals replaced by ?, whitespace collapsed -
+ * so ad-hoc Execute() calls with inlined values share one line. Rows come from
+ * SQLITE_TRACE_ROW; fullscan/sort/autoindex/vm-step counters are read (and
+ * reset) from sqlite3_stmt_status at the end of every run.
+ *
+ *   db.EnableProfiler(std::chrono::milliseconds(200));
+ *   ...
+ *   LOG_INFO(db.DumpProfile());
+ */
+class wpSQLProfiler {
+public:
+    static constexpr int nBuckets = 64 * 4;  // log2 buckets with 4 linear steps each; upper bound error < 25%
+
+    struct Entry {
+        std::string sql;
+        int64_t calls {0};
+        int64_t rows {0};
+        int64_t totalNanos {0};
+        int64_t maxNanos {0};
+        int64_t fullScanSteps {0};
+        int64_t sorts {0};
+        int64_t autoIndexes {0};
+        int64_t vmSteps {0};
+        std::array<uint32_t, nBuckets> histogram {};
+
+        int64_t Percentile(double q) const;  // nanoseconds
+    };
+
+    enum class SortBy { TotalTime, Calls, P99, MaxTime, Rows, FullScanSteps, VMSteps };
+
+private:
+    struct Cached {
+        std::string rawSql;
+        Entry *entry;
+    };
+
+    sqlite3 *db;
+    int64_t slowNanos;
+    mutable std::mutex mtx;
+    std::unordered_map<std::string, Entry> entries;           // normalized sql -> entry
+    std::unordered_map<sqlite3_stmt *, Cached> statements;    // skips normalizing for prepared statements
+    std::unordered_map<sqlite3_stmt *, int64_t> pendingRows;  // rows of runs still stepping
+
+    static int TraceCallback(unsigned type, void *self, void *p, void *x);
+    void OnProfile(sqlite3_stmt *stmt, int64_t nanos);
+
+public:
+    wpSQLProfiler(sqlite3 *db, std::chrono::milliseconds slowQueryThreshold);
+    ~wpSQLProfiler();
+    wpSQLProfiler(const wpSQLProfiler &) = delete;
+    wpSQLProfiler &operator=(const wpSQLProfiler &) = delete;
+
+    void SetSlowQueryThreshold(std::chrono::milliseconds threshold) { slowNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(threshold).count(); }
+    std::vector<Entry> Snapshot(SortBy sortBy = SortBy::TotalTime) const;
+    std::string DumpProfile(SortBy sortBy = SortBy::TotalTime, size_t limit = 50) const;
+    void Reset();
+
+    static std::string Normalize(std::string_view sql);
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "sqlite3.h"
+
+/**
+ * Opt-in query plan advisor.
+ *
+ * The first time a distinct statement (SQL text with its literals normalized
+ * away, see wpSQLProfiler::Normalize) is prepared on the connection it is run
+ * through EXPLAIN QUERY PLAN and every plan step that is a full table scan,
+ * a temp b-tree (ORDER BY/GROUP BY/DISTINCT sort) or an automatic index is
+ * recorded. For scans and automatic indexes the columns constrained in the
+ * statement are checked against the table's existing indexes (pragma
+ * index_list/index_info) and, when none covers them, a create index statement
+ * in the DBObjects style is suggested:
+ *
+ *   create index idx_member_name on member(name)
+ *
+ * Findings are logged with LOG_WARN and kept in memory. They are written to
+ * the wp_query_advice table only by Flush(), Reset() or the destructor (so on
+ * DisableQueryAdvisor or Close), never from inside a prepare, and only when
+ * the connection is in autocommit mode so the advisor never joins or blocks a
+ * transaction it did not start.
+ *
+ *   db.EnableQueryAdvisor();
+ *   ...
+ *   db.GetQueryAdvisor()->Flush();
+ *   for (auto &a : db.GetQueryAdvisor()->GetAdvice()) LOG_INFO("{}", a.suggestion);
+ */
+class wpSQLQueryAdvisor {
+public:
+    static constexpr auto tableName = "wp_query_advice";
+
+    enum class Finding { FullScan, TempBTree, AutomaticIndex };
+
+    struct Advice {
+        std::string sql;
+        Finding finding;
+        std::string table;
+        std::string detail;      // EXPLAIN QUERY PLAN detail line
+        std::string suggestion;  // create index statement; empty when an existing index covers the columns
+    };
+
+private:
+    sqlite3 *db;
+    bool persist;
+    bool tableReady {false};
+    std::mutex mtx;
+    std::unordered_set<std::string> seen;
+    std::vector<Advice> advice;
+    size_t nPersisted {0};
+
+    std::vector<std::string> TableColumns(const std::string &table);
+    std::vector<std::vector<std::string>> TableIndexes(const std::string &table);
+    std::string Suggest(const std::string &table, const std::vector<std::string> &planColumns);
+    void Persist();
+
+public:
+    wpSQLQueryAdvisor(sqlite3 *db, bool persist = true);
+    ~wpSQLQueryAdvisor();
+    wpSQLQueryAdvisor(const wpSQLQueryAdvisor &) = delete;
+    wpSQLQueryAdvisor &operator=(const wpSQLQueryAdvisor &) = delete;
+
+    void Inspect(sqlite3_stmt *stmt);  // no-op after the first call for a given normalized SQL; never writes
+    void Flush();                      // writes advice not yet in tableName; does nothing inside a transaction
+    std::vector<Advice> GetAdvice();
+    std::vector<std::string> GetSuggestedIndexes();  // distinct create index statements
+    void Reset();
+
+    static const char *FindingName(Finding f);
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Append-only string arena with a dedupe table, used by wpSQLResultSet to
+ * intern text columns: Get<std::string_view>(i) returns a view into the arena
+ * owned by the result set, and a value seen before costs a hash lookup instead
+ * of an allocation. Views stay valid until the result set is destroyed.
+ *
+ * Meant for low-cardinality columns (type names, codes, status) read over many
+ * rows; every distinct value is kept for the life of the result set.
+ */
+class wpSQLStringArena {
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char *cursor {nullptr};
+    size_t left {0};
+    size_t bytes {0};
+    std::unordered_map<std::string_view, std::string_view> table;  // raw column text -> interned utf-8
+
+    std::string_view Store(std::string_view s);
+
+public:
+    wpSQLStringArena() = default;
+    wpSQLStringArena(const wpSQLStringArena &) = delete;
+    wpSQLStringArena &operator=(const wpSQLStringArena &) = delete;
+
+    std::string_view Intern(std::string_view text);
+    size_t Count() const { return table.size(); }
+    size_t Bytes() const { return bytes; }  // arena memory in use, including the chunk slack
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+/**
+ * UTF-8 <-> wchar_t transcoding for the wstring binds and reads. wchar_t is
+ * UTF-32 on Linux and UTF-16 on Windows; both are handled. Runs of 16 ASCII
+ * characters are converted with SSE2 a block at a time, everything else one
+ * code point at a time. Invalid sequences are skipped, the same as
+ * boost::locale::conv::utf_to_utf, so results match the old conversions.
+ */
+namespace wpUTF {
+    void AppendUTF8(std::wstring_view in, std::string &out);
+    void AppendWide(std::string_view in, std::wstring &out);
+
+    inline std::string ToUTF8(std::wstring_view in) {
+        std::string out;
+        AppendUTF8(in, out);
+        return out;
+    }
+    inline std::wstring ToWide(std::string_view in) {
+        std::wstring out;
+        AppendWide(in, out);
+        return out;
+    }
+}
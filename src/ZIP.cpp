@@ -39,7 +39,17 @@ extern "C"{
 }
 #endif
 
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <fstream>
 #include <iomanip>
@@ -47,6 +57,7 @@ extern "C"{
 #include <stdexcept>
 #include <cstring>
 #include <string>
+#include <thread>
 
 #include "ZIP.h"
 
@@ -573,6 +584,250 @@ void ZipFileReader::Get_File_List(std::vector<std::string>& filenames) const
         filenames.push_back(i->first);
 }
 //#####################################################################
+// Function Read_Mapped
+//#####################################################################
+template<class T>
+inline T Read_Mapped(const unsigned char* p)
+{
+    T x;std::memcpy(&x,p,sizeof(T));return x;
+}
+//#####################################################################
+// Function ZipFileMappedReader
+//#####################################################################
+ZipFileMappedReader::
+ZipFileMappedReader(const std::string &filename)
+    :base(0),length(0)
+{
+#ifdef _WIN32
+    file_handle=mapping_handle=0;
+    HANDLE file=CreateFileA(filename.c_str(),GENERIC_READ,FILE_SHARE_READ,0,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,0);
+    if(file==INVALID_HANDLE_VALUE) throw std::runtime_error("ZIP: Invalid file handle");
+    file_handle=file;
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file,&size)){CloseHandle(file);throw std::runtime_error("ZIP: cannot stat file");}
+    length=static_cast<size_t>(size.QuadPart);
+    if(length>0){
+        HANDLE mapping=CreateFileMappingA(file,0,PAGE_READONLY,0,0,0);
+        if(!mapping){CloseHandle(file);throw std::runtime_error("ZIP: cannot map file");}
+        mapping_handle=mapping;
+        base=static_cast<const unsigned char*>(MapViewOfFile(mapping,FILE_MAP_READ,0,0,0));
+        if(!base){CloseHandle(mapping);CloseHandle(file);throw std::runtime_error("ZIP: cannot map file");}}
+#else
+    fd=open(filename.c_str(),O_RDONLY);
+    if(fd<0) throw std::runtime_error("ZIP: Invalid file handle");
+    struct stat st;
+    if(fstat(fd,&st)!=0){close(fd);throw std::runtime_error("ZIP: cannot stat file");}
+    length=static_cast<size_t>(st.st_size);
+    if(length>0){
+        void* p=mmap(0,length,PROT_READ,MAP_SHARED,fd,0);
+        if(p==MAP_FAILED){close(fd);throw std::runtime_error("ZIP: cannot map file");}
+        base=static_cast<const unsigned char*>(p);
+        madvise(p,length,MADV_WILLNEED);}
+#endif
+    if(!Find_And_Read_Central_Header()){
+        // the destructor does not run for a throwing constructor
+#ifdef _WIN32
+        if(base) UnmapViewOfFile(base);
+        if(mapping_handle) CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+#else
+        if(base) munmap(const_cast<unsigned char*>(base),length);
+        close(fd);
+#endif
+        throw std::runtime_error("ZIP: corrupt or truncated archive "+filename);}
+}
+//#####################################################################
+// Function ~ZipFileMappedReader
+//#####################################################################
+ZipFileMappedReader::
+~ZipFileMappedReader()
+{
+#ifdef _WIN32
+    if(base) UnmapViewOfFile(base);
+    if(mapping_handle) CloseHandle(mapping_handle);
+    if(file_handle) CloseHandle(file_handle);
+#else
+    if(base) munmap(const_cast<unsigned char*>(base),length);
+    close(fd);
+#endif
+}
+//#####################################################################
+// Function Find_And_Read_Central_Header
+//#####################################################################
+bool ZipFileMappedReader::
+Find_And_Read_Central_Header()
+{
+    // the end of central directory record is 22 bytes plus an optional comment of up to 64k
+    const size_t eocd_size=22;
+    if(length<eocd_size){std::cerr<<"ZIP: file too small"<<std::endl;return false;}
+    size_t lowest=length>eocd_size+0xffff?length-eocd_size-0xffff:0;
+    size_t found=length;
+    for(size_t i=length-eocd_size+1;i-->lowest;)
+        if(Read_Mapped<unsigned int>(base+i)==0x06054b50){found=i;break;}
+    if(found==length){std::cerr<<"ZIP: Failed to find zip header"<<std::endl;return false;}
+    const unsigned char* eocd=base+found;
+    unsigned short disk_number1=Read_Mapped<unsigned short>(eocd+4),disk_number2=Read_Mapped<unsigned short>(eocd+6);
+    if(disk_number1!=disk_number2 || disk_number1!=0){
+        std::cerr<<"ZIP: multiple disk zip files are not supported"<<std::endl;return false;}
+    unsigned short num_files=Read_Mapped<unsigned short>(eocd+8);
+    if(num_files!=Read_Mapped<unsigned short>(eocd+10)){
+        std::cerr<<"ZIP: multi disk zip files are not supported"<<std::endl;return false;}
+    size_t offset=Read_Mapped<unsigned int>(eocd+16);
+    for(int i=0;i<num_files;i++){
+        // central file header is 46 bytes followed by name, extra field and comment
+        if(offset+46>length || Read_Mapped<unsigned int>(base+offset)!=0x02014b50){
+            std::cerr<<"Did not find global header signature"<<std::endl;return false;}
+        const unsigned char* h=base+offset;
+        Entry entry;
+        entry.compression_type=Read_Mapped<unsigned short>(h+10);
+        entry.crc=Read_Mapped<unsigned int>(h+16);
+        entry.compressed_size=Read_Mapped<unsigned int>(h+20);
+        entry.uncompressed_size=Read_Mapped<unsigned int>(h+24);
+        unsigned short filename_length=Read_Mapped<unsigned short>(h+28);
+        unsigned short extra_length=Read_Mapped<unsigned short>(h+30);
+        unsigned short comment_length=Read_Mapped<unsigned short>(h+32);
+        size_t header_offset=Read_Mapped<unsigned int>(h+42);
+        if(offset+46+filename_length>length){std::cerr<<"ZIP: truncated central header"<<std::endl;return false;}
+        entry.filename.assign(reinterpret_cast<const char*>(h+46),filename_length);
+        offset+=46+filename_length+extra_length+comment_length;
+        // the local header carries its own name/extra lengths which decide where the data starts
+        if(header_offset+30>length || Read_Mapped<unsigned int>(base+header_offset)!=0x04034b50){
+            std::cerr<<"Did not find local header signature"<<std::endl;continue;}
+        entry.data_offset=header_offset+30+Read_Mapped<unsigned short>(base+header_offset+26)+Read_Mapped<unsigned short>(base+header_offset+28);
+        if(entry.data_offset+entry.compressed_size>length){
+            std::cerr<<"ZIP: entry "<<entry.filename<<" exceeds archive size"<<std::endl;continue;}
+        if(entry.compression_type!=0 && entry.compression_type!=8){
+            std::cerr<<"ZIP: got unrecognized compressed data (Supported deflate/uncompressed)"<<std::endl;continue;}
+        entries[entry.filename]=entry;}
+    return true;
+}
+//#####################################################################
+// Function Find
+//#####################################################################
+const ZipFileMappedReader::Entry* ZipFileMappedReader::
+Find(const std::string &filename) const
+{
+    std::map<std::string,Entry>::const_iterator i=entries.find(filename);
+    return i==entries.end()?0:&i->second;
+}
+//#####################################################################
+// Function Get_File_List
+//#####################################################################
+void ZipFileMappedReader::
+Get_File_List(std::vector<std::string>& filenames) const
+{
+    filenames.clear();
+    for(std::map<std::string,Entry>::const_iterator i=entries.begin();i!=entries.end();++i)
+        filenames.push_back(i->first);
+}
+//#####################################################################
+// Function Get_Raw
+//#####################################################################
+// bytes of the entry exactly as stored in the archive (deflate stream for compressed entries)
+std::span<const unsigned char> ZipFileMappedReader::
+Get_Raw(const std::string &filename) const
+{
+    const Entry* entry=Find(filename);
+    if(!entry) return {};
+    return {base+entry->data_offset,entry->compressed_size};
+}
+//#####################################################################
+// Function Get_Stored
+//#####################################################################
+// zero-copy view of an uncompressed entry; empty for missing or deflated entries
+std::span<const unsigned char> ZipFileMappedReader::
+Get_Stored(const std::string &filename) const
+{
+    const Entry* entry=Find(filename);
+    if(!entry || !entry->Is_Stored()) return {};
+    return {base+entry->data_offset,entry->uncompressed_size};
+}
+//#####################################################################
+// Function Extract
+//#####################################################################
+// decompress a whole entry into buffer which must hold uncompressed_size bytes
+bool ZipFileMappedReader::
+Extract(const std::string &filename,unsigned char* buffer,size_t buffer_size) const
+{
+    const Entry* entry=Find(filename);
+    if(!entry){std::cerr<<"ZIP: "<<filename<<" not found"<<std::endl;return false;}
+    if(buffer_size<entry->uncompressed_size){std::cerr<<"ZIP: buffer too small for "<<filename<<std::endl;return false;}
+    if(entry->Is_Stored()) std::memcpy(buffer,base+entry->data_offset,entry->uncompressed_size);
+    else{
+        z_stream strm;
+        strm.zalloc=Z_NULL;strm.zfree=Z_NULL;strm.opaque=Z_NULL;
+        if(inflateInit2(&strm,-MAX_WBITS)!=Z_OK){std::cerr<<"gzip: inflateInit2 did not return Z_OK"<<std::endl;return false;}
+        strm.next_in=const_cast<Bytef*>(base+entry->data_offset);
+        strm.avail_in=entry->compressed_size;
+        strm.next_out=buffer;
+        strm.avail_out=entry->uncompressed_size;
+        int ret=inflate(&strm,Z_FINISH);
+        inflateEnd(&strm);
+        if(ret!=Z_STREAM_END){std::cerr<<"gzip error "<<(strm.msg?strm.msg:"incomplete stream")<<std::endl;return false;}}
+    if(crc32(0,buffer,entry->uncompressed_size)!=entry->crc){std::cerr<<"ZIP: crc mismatch on "<<filename<<std::endl;return false;}
+    return true;
+}
+//#####################################################################
+// Function Extract
+//#####################################################################
+// feed an entry to sink in pieces of up to chunk_size bytes; stored entries are passed straight from the mapping
+bool ZipFileMappedReader::
+Extract(const std::string &filename,const Sink& sink,size_t chunk_size) const
+{
+    const Entry* entry=Find(filename);
+    if(!entry){std::cerr<<"ZIP: "<<filename<<" not found"<<std::endl;return false;}
+    if(chunk_size==0) chunk_size=default_chunk_size;
+    const unsigned char* data=base+entry->data_offset;
+    unsigned int crc=0;
+    if(entry->Is_Stored()){
+        for(size_t done=0;done<entry->uncompressed_size;){
+            size_t n=std::min(chunk_size,entry->uncompressed_size-done);
+            crc=crc32(crc,data+done,static_cast<uInt>(n));
+            if(!sink(data+done,n)) return false;
+            done+=n;}}
+    else{
+        std::vector<unsigned char> out(chunk_size);
+        z_stream strm;
+        strm.zalloc=Z_NULL;strm.zfree=Z_NULL;strm.opaque=Z_NULL;
+        if(inflateInit2(&strm,-MAX_WBITS)!=Z_OK){std::cerr<<"gzip: inflateInit2 did not return Z_OK"<<std::endl;return false;}
+        strm.next_in=const_cast<Bytef*>(data);
+        strm.avail_in=entry->compressed_size;
+        int ret=Z_OK;
+        while(ret!=Z_STREAM_END){
+            strm.next_out=out.data();
+            strm.avail_out=static_cast<uInt>(out.size());
+            ret=inflate(&strm,Z_NO_FLUSH);
+            if(ret!=Z_OK && ret!=Z_STREAM_END){
+                std::cerr<<"gzip error "<<(strm.msg?strm.msg:"truncated stream")<<std::endl;
+                inflateEnd(&strm);return false;}
+            size_t n=out.size()-strm.avail_out;
+            crc=crc32(crc,out.data(),static_cast<uInt>(n));
+            if(n>0 && !sink(out.data(),n)){inflateEnd(&strm);return false;}}
+        inflateEnd(&strm);}
+    if(crc!=entry->crc){std::cerr<<"ZIP: crc mismatch on "<<filename<<std::endl;return false;}
+    return true;
+}
+//#####################################################################
+// Function Extract_Parallel
+//#####################################################################
+// extract independent entries concurrently; sink_for is called once per entry from the worker thread
+bool ZipFileMappedReader::
+Extract_Parallel(const std::vector<std::string>& filenames,const std::function<Sink(const std::string&)>& sink_for,unsigned int n_threads) const
+{
+    if(n_threads==0) n_threads=std::max(1u,std::thread::hardware_concurrency());
+    n_threads=std::min<unsigned int>(n_threads,static_cast<unsigned int>(filenames.size()));
+    std::atomic<size_t> next(0);
+    std::atomic<bool> ok(true);
+    auto worker=[&](){
+        for(size_t i=next++;i<filenames.size();i=next++)
+            if(!Extract(filenames[i],sink_for(filenames[i]))) ok=false;};
+    std::vector<std::thread> threads;
+    for(unsigned int i=1;i<n_threads;i++) threads.emplace_back(worker);
+    worker();
+    for(auto& t:threads) t.join();
+    return ok;
+}
+//#####################################################################
 // Function Gzip_In
 //#####################################################################
 std::istream* 
@@ -0,0 +1,149 @@
+#include "asyncDatabase.h"
+#include "logging.hpp"
+
+bool DB::AsyncCancel::Enter(wpSQLDatabase *db) const {
+    std::lock_guard<std::mutex> lock(state->mtx);
+    if (state->cancelled) return false;
+    state->running.push_back(db);
+    return true;
+}
+
+void DB::AsyncCancel::Leave(wpSQLDatabase *db) const {
+    std::lock_guard<std::mutex> lock(state->mtx);
+    std::erase(state->running, db);
+}
+
+void DB::AsyncCancel::Cancel() {
+    std::lock_guard<std::mutex> lock(state->mtx);
+    state->cancelled = true;
+    for (auto db : state->running) db->Interrupt();
+}
+
+void DB::AsyncRows::Read(wpSQLResultSet &rs) {
+    int nCols = rs.GetColumnCount();
+    columns.clear();
+    values.clear();
+    for (int i = 0; i < nCols; i++) columns.push_back(rs.GetColumnName(i));
+    while (rs.NextRow()) {
+        for (int i = 0; i < nCols; i++) {
+            switch (rs.GetColumnType(i)) {
+            case SQLITE_INTEGER: values.emplace_back(rs.Get<int64_t>(i)); break;
+            case SQLITE_FLOAT: values.emplace_back(rs.Get<double>(i)); break;
+            case SQLITE_TEXT: values.emplace_back(rs.Get<std::string>(i)); break;
+            case SQLITE_BLOB: {
+                int64_t len = 0;
+                auto data = rs.GetBlob(i, len);
+                values.emplace_back(std::vector<uint8_t>(data, data + len));
+                break;
+            }
+            default: values.emplace_back(std::monostate {}); break;
+            }
+        }
+    }
+}
+
+int DB::AsyncRows::GetColumnIndex(std::string_view name) const {
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].size() == name.size() && sqlite3_strnicmp(columns[i].data(), name.data(), static_cast<int>(name.size())) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+DB::AsyncDatabase::AsyncDatabase(const std::string &fileName, const Options &opt) : dbName(fileName), options(opt) {
+    for (int i = 0; i < std::max(1, options.connections); i++) {
+        auto db = std::make_unique<wpSQLDatabase>();
+        db->Open(dbName, options.mode, options.vfsName);
+        db->EnableStatementCache();
+        connections.push_back(std::move(db));
+    }
+    for (auto &db : connections) workers.emplace_back([this, conn = db.get()] { Run(*conn); });
+    LOG_INFO("async database {} started with {} connections", dbName, connections.size());
+}
+
+void DB::AsyncDatabase::Post(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!stopping) {
+            queue.push_back(std::move(job));
+            cv.notify_one();
+            return;
+        }
+    }
+    job.fail(std::make_exception_ptr(wpSQLException(fmt::format("AsyncDatabase> {} is stopped", dbName), SQLITE_MISUSE, NULL)));
+}
+
+void DB::AsyncDatabase::Run(wpSQLDatabase &db) {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) break;
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        if (job.cancel.Enter(&db)) {
+            job.run(db);
+            job.cancel.Leave(&db);
+            job.complete();  // last: without Options::post the caller resumes right here, and may cancel or stop
+        } else {
+            job.fail(std::make_exception_ptr(wpSQLException("AsyncDatabase> cancelled before it started", SQLITE_INTERRUPT, NULL)));
+        }
+        lock.lock();
+    }
+}
+
+void DB::AsyncDatabase::Interrupt() {
+    for (auto &db : connections) db->Interrupt();
+}
+
+size_t DB::AsyncDatabase::GetQueueLength() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return queue.size();
+}
+
+void DB::AsyncDatabase::Stop() {
+    std::deque<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping) return;
+        for (auto &worker : workers) {
+            if (worker.get_id() == std::this_thread::get_id()) throw wpSQLException(fmt::format("AsyncDatabase::Stop> {} cannot be stopped from its own worker", dbName), SQLITE_MISUSE, NULL);
+        }
+        stopping = true;
+        dropped.swap(queue);
+    }
+    cv.notify_all();
+    Interrupt();
+    for (auto &worker : workers) worker.join();
+    workers.clear();
+    for (auto &job : dropped) job.fail(std::make_exception_ptr(wpSQLException(fmt::format("AsyncDatabase> {} stopped before the call ran", dbName), SQLITE_INTERRUPT, NULL)));
+    for (auto &db : connections) db->Close();
+    LOG_INFO("async database {} stopped, {} queued calls dropped", dbName, dropped.size());
+}
+
+void DB::AsyncRunLoop::Post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.push_back(std::move(fn));
+    }
+    cv.notify_one();
+}
+
+bool DB::AsyncRunLoop::RunOne() {
+    std::function<void()> fn;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (queue.empty()) return false;
+        fn = std::move(queue.front());
+        queue.pop_front();
+    }
+    fn();
+    return true;
+}
+
+void DB::AsyncRunLoop::RunUntil(const std::function<bool()> &done) {
+    while (!done()) {
+        if (RunOne()) continue;
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock, std::chrono::milliseconds(10), [this] { return !queue.empty(); });  // the timeout catches done() turning true without a post
+    }
+}
@@ -0,0 +1,149 @@
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <fmt/format.h>
+#include "auditLog.h"
+#include "logging.hpp"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static bool SyncFile(std::FILE *f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+static void AppendJSONString(std::string &out, const std::string &s) {
+    out.push_back('"');
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (c < 0x20)
+                    fmt::format_to(std::back_inserter(out), "\\u{:04x}", c);
+                else
+                    out.push_back(static_cast<char>(c));
+        }
+    }
+    out.push_back('"');
+}
+
+DB::AuditSink::AuditSink(const Options &opt) : options(opt) {
+    file = std::fopen(options.fileName.c_str(), "ab");
+    if (!file) throw std::runtime_error(fmt::format("cannot open audit file {}: {}", options.fileName, std::strerror(errno)));
+    queue.reserve(options.batchSize);
+    writing.reserve(options.batchSize);
+    lastSync = std::chrono::steady_clock::now();
+    worker = std::thread([this] { Run(); });
+}
+
+DB::AuditSink::~AuditSink() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cvWork.notify_all();
+    cvRoom.notify_all();
+    worker.join();
+    if (options.sync != SyncPolicy::None && !SyncFile(file)) Failed("fsync");
+    if (std::fclose(file) != 0) Failed("fclose");
+}
+
+void DB::AuditSink::Write(const std::string &action, const std::string &entity, int entityId, int userId, const std::string &details, const std::string &requestId) {
+    Record r {std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count(), entityId, userId, action, entity, details, requestId};
+    std::unique_lock<std::mutex> lock(mtx);
+    if (queue.size() >= options.queueLimit) {
+        stats.blockedWrites++;
+        cvRoom.wait(lock, [this] { return queue.size() < options.queueLimit || stopping; });
+    }
+    queue.push_back(std::move(r));
+    enqueued++;
+    if (queue.size() == options.batchSize) cvWork.notify_one();
+}
+
+void DB::AuditSink::Flush() {
+    std::unique_lock<std::mutex> lock(mtx);
+    auto target = enqueued;
+    auto ticket = ++flushTicket;
+    cvWork.notify_one();
+    cvDone.wait(lock, [this, target, ticket] { return completed >= target && flushServed >= ticket; });
+}
+
+void DB::AuditSink::Run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cvWork.wait_for(lock, options.flushInterval, [this] { return stopping || flushTicket > flushServed || queue.size() >= options.batchSize; });
+        auto ticket = flushTicket;
+        if (queue.empty() && ticket == flushServed) {
+            if (stopping) break;
+            continue;
+        }
+        writing.swap(queue);
+        auto n = static_cast<int64_t>(writing.size());
+        lock.unlock();
+        cvRoom.notify_all();
+        WriteBatch(ticket > flushServed);
+        lock.lock();
+        completed += n;
+        flushServed = ticket;
+        cvDone.notify_all();
+    }
+}
+
+void DB::AuditSink::Failed(const char *what) {
+    stats.errors++;
+    LOG_ERROR("audit log {}: {} failed: {}", options.fileName, what, std::strerror(errno));
+}
+
+void DB::AuditSink::WriteBatch(bool forceSync) {
+    buffer.clear();
+    for (auto &r : writing) {
+        fmt::format_to(std::back_inserter(buffer), "{{\"ts\":{},\"action\":", r.timeMicros);
+        AppendJSONString(buffer, r.action);
+        buffer.append(",\"entity\":");
+        AppendJSONString(buffer, r.entity);
+        fmt::format_to(std::back_inserter(buffer), ",\"entity_id\":{},\"user_id\":{},\"request_id\":", r.entityId, r.userId);
+        AppendJSONString(buffer, r.requestId);  // set by callers through Logger::setRequestId, so it may hold anything
+        buffer.append(",\"details\":");
+        AppendJSONString(buffer, r.details);
+        buffer.append("}\n");
+    }
+    bool written = true;
+    if (!buffer.empty()) {
+        if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            Failed("write");
+            written = false;
+        }
+        if (std::fflush(file) != 0) {
+            if (written) Failed("flush");
+            written = false;
+        }
+        if (!written) std::clearerr(file);  // so the next batch gets its own attempt
+    }
+    auto now = std::chrono::steady_clock::now();
+    bool sync = options.sync == SyncPolicy::EveryBatch || (options.sync == SyncPolicy::Interval && (forceSync || now - lastSync >= options.syncInterval));
+    if (sync) {
+        lastSync = now;
+        if (SyncFile(file))
+            stats.syncs++;
+        else
+            Failed("fsync");
+    }
+    if (!writing.empty()) stats.batches++;
+    if (written) {
+        stats.records += static_cast<int64_t>(writing.size());
+        stats.bytes += static_cast<int64_t>(buffer.size());
+    } else {
+        stats.lostRecords += static_cast<int64_t>(writing.size());
+    }
+    writing.clear();
+}
@@ -1,4 +1,5 @@
 #include <string>
+#include <chrono>
 #include <filesystem>
 #include "rDb.h"
 
@@ -62,7 +63,7 @@ bool DB::SQLiteBase::BackupDB(int noOfBackupToKeep, std::string folderName, std:
         {
             LOG_INFO("Hourly Backup Master started. {}", GetDBName());
             wpSQLDatabase toBackup;
-            toBackup.Open(GetDBName());
+            toBackup.Open(GetDBName(), OpenMode::ReadWrite, _vfsName);
             if (toBackup.BackupTo(folderName + fileName, fnIsStopping) != SQLITE_OK) return false;
             LOG_INFO("Hourly Backup Master completed. {}", GetDBName());
         }
@@ -149,3 +150,181 @@ bool DB::SQLiteBase::BackupDB(int noOfBackupToKeep, std::string folderName, std:
     }
     return false;
 }
+
+// inflate one backup entry into <target>.restore and check it; returns the verified file name or empty on failure.
+static std::string ExtractAndVerify(const Partio::ZipFileMappedReader &zip, const std::string &entryName, const std::string &target, std::function<bool()> fnIsStopping) {
+    auto entry = zip.Find(entryName);
+    if (!entry) {
+        LOG_ERROR("Restore: {} not found in backup", entryName);
+        return "";
+    }
+    std::string restoreName = target + ".restore";
+    auto timeStart = std::chrono::steady_clock::now();
+    {
+        std::ofstream out(restoreName, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("Restore: cannot create {}", restoreName);
+            return "";
+        }
+        bool ok = zip.Extract(entryName, [&](const unsigned char *data, size_t len) {
+            if (fnIsStopping && fnIsStopping()) return false;
+            out.write(reinterpret_cast<const char *>(data), len);
+            return out.good();
+        });
+        out.close();
+        if (!ok || !out) {
+            LOG_ERROR("Restore: extracting {} failed", entryName);
+            fs::remove(restoreName);
+            return "";
+        }
+    }
+    auto timeExtracted = std::chrono::steady_clock::now();
+    std::string result;
+    try {  // a truncated entry or one that is not a database throws, e.g. SQLITE_NOTADB
+        wpSQLDatabase check;
+        check.Open(restoreName);
+        check.Execute("pragma quick_check", [&result](int, char **data, char **) {
+            if (data[0]) result.append(data[0]);
+        });
+    } catch (wpSQLException &e) {
+        result = e.message;
+    } catch (std::exception &e) {
+        result = e.what();
+    }
+    if (!boost::iequals(result, "ok")) {
+        LOG_ERROR("Restore: quick_check on {} failed: {}", restoreName, result);
+        fs::remove(restoreName);
+        return "";
+    }
+    auto secExtract = std::chrono::duration<double>(timeExtracted - timeStart).count();
+    auto secTotal = std::chrono::duration<double>(std::chrono::steady_clock::now() - timeStart).count();
+    LOG_INFO("Restore: {} {} bytes extracted in {:.3f}s ({:.1f} MB/s), verified in {:.3f}s",
+        entryName, entry->uncompressed_size, secExtract, entry->uncompressed_size / 1048576.0 / std::max(secExtract, 1e-9), secTotal - secExtract);
+    return restoreName;
+}
+
+// backups are plain sqlite files; re-encode through the vfs, if any, and return the file to move into place
+static std::string PrepareRestoredFile(const std::string &restoreName, const std::string &vfsName) {
+    if (vfsName.empty()) return restoreName;
+    std::string source = restoreName + ".vfs";
+    fs::remove(source);
+    try {
+        wpSQLDatabase plain;
+        plain.Open(restoreName, OpenMode::ReadOnly);
+        if (plain.BackupTo(fmt::format("file:{}?vfs={}", source, vfsName), nullptr, nullptr, -1, 0) != 0)
+            throw std::runtime_error(fmt::format("cannot convert {} to vfs {}", restoreName, vfsName));
+    } catch (...) {
+        std::error_code ec;
+        fs::remove(source, ec);  // the caller still owns restoreName and removes it
+        throw;
+    }
+    fs::remove(restoreName);
+    return source;
+}
+
+namespace {
+    struct RestoreSwap {
+        std::string source, target;
+        bool movedIn {false};
+    };
+    // the database and the wal/shm/journal files that must not be applied to the restored copy
+    const char *const restoreSuffixes[] = {"", "-wal", "-shm", "-journal"};
+    std::string Aside(const std::string &target, const char *suffix) { return target + ".pre-restore" + suffix; }
+}
+
+// puts the live files moved aside by SwapInRestoredFiles back, and the restored copies back to their sources
+static void RollBackRestoredFiles(std::vector<RestoreSwap> &swaps) {
+    for (auto &swap : swaps) {
+        std::error_code ec;
+        if (swap.movedIn) {
+            fs::rename(swap.target, swap.source, ec);
+            if (!ec) swap.movedIn = false;
+        }
+        for (auto suffix : restoreSuffixes)
+            if (fs::exists(Aside(swap.target, suffix))) fs::rename(Aside(swap.target, suffix), swap.target + suffix, ec);
+        if (ec) LOG_ERROR("Restore: cannot move {} back: {}", swap.target, ec.message());
+    }
+}
+
+// every live file is moved aside before any restored copy goes in, so a failure part way can put all of them back
+// and the master and transaction databases are never left from different points in time.
+// leftovers of an interrupted restore are removed by RestoreDB first, so everything aside here is a live file.
+static void SwapInRestoredFiles(std::vector<RestoreSwap> &swaps) {
+    try {
+        for (auto &swap : swaps)
+            for (auto suffix : restoreSuffixes)
+                if (fs::exists(swap.target + suffix)) fs::rename(swap.target + suffix, Aside(swap.target, suffix));
+        for (auto &swap : swaps) {
+            fs::rename(swap.source, swap.target);
+            swap.movedIn = true;
+        }
+    } catch (...) {
+        RollBackRestoredFiles(swaps);
+        throw;
+    }
+}
+
+bool DB::SQLiteBase::RestoreDB(const std::string &zipFileName, std::function<bool()> fnIsStopping) {
+    auto fileName = fs::path(GetDBName()).filename().string();
+    auto tFileName = fs::path(GetTransactionDBName()).filename().string();
+    bool closed = false, swapping = false;
+    std::vector<RestoreSwap> swaps;
+    try {
+        LOG_INFO("Restore from {} started. {}", zipFileName, GetDBName());
+        auto timeStart = std::chrono::steady_clock::now();
+        Partio::ZipFileMappedReader zip(zipFileName);
+
+        auto restoredMaster = ExtractAndVerify(zip, fileName, GetDBName(), fnIsStopping);
+        if (restoredMaster.empty()) return false;
+        swaps.push_back({restoredMaster, GetDBName()});
+        if (!tFileName.empty() && zip.Find(tFileName)) {
+            auto restoredTrans = ExtractAndVerify(zip, tFileName, GetTransactionDBName(), fnIsStopping);
+            if (restoredTrans.empty()) {
+                fs::remove(restoredMaster);
+                return false;
+            }
+            swaps.push_back({restoredTrans, GetTransactionDBName()});
+        }
+        if (fnIsStopping && fnIsStopping()) {
+            for (auto &swap : swaps) fs::remove(swap.source);
+            return false;
+        }
+        swaps[0].source = PrepareRestoredFile(swaps[0].source, _vfsName);
+
+        closed = IsOpened();
+        if (closed) Close();
+        for (auto &swap : swaps)
+            for (auto suffix : restoreSuffixes) fs::remove(Aside(swap.target, suffix));
+        swapping = true;
+        SwapInRestoredFiles(swaps);
+        if (closed) Open(false, openMode);  // a restored copy that does not open is rolled back below
+        closed = false;
+        std::error_code ec;
+        for (auto &swap : swaps)
+            for (auto suffix : restoreSuffixes) fs::remove(Aside(swap.target, suffix), ec);
+
+        auto sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - timeStart).count();
+        LOG_INFO("Restore from {} completed in {:.3f}s. {}", zipFileName, sec, GetDBName());
+        return true;
+    } catch (std::exception &e) {
+        LOG_ERROR("Restore error: {}", e.what());
+    } catch (wpSQLException &e) {
+        LOG_ERROR("Restore sql error: {}", e.message);
+    } catch (...) {
+        LOG_ERROR("Restore error: unknown!");
+    }
+    if (closed && IsOpened()) Close();
+    if (swapping) RollBackRestoredFiles(swaps);
+    std::error_code ec;
+    for (auto &swap : swaps) fs::remove(swap.source, ec);
+    if (closed) {  // the live files are back in place; reopen them as they were
+        try {
+            Open(false, openMode);
+        } catch (wpSQLException &e) {
+            LOG_ERROR("Restore: reopening {} failed: {}", GetDBName(), e.message);
+        } catch (std::exception &e) {
+            LOG_ERROR("Restore: reopening {} failed: {}", GetDBName(), e.what());
+        }
+    }
+    return false;
+}
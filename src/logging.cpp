@@ -1,14 +1,19 @@
 #include "logging.hpp"
+#include "auditLog.h"
+#include <spdlog/async.h>
 #include <spdlog/pattern_formatter.h>
+#include <spdlog/sinks/rotating_file_sink.h>
 #include <chrono>
 #include <random>
-#include <iomanip>
-#include <sstream>
 
 namespace DB {
 
-std::shared_ptr<spdlog::logger> Logger::defaultLogger_;
+std::atomic<spdlog::logger*> Logger::defaultLogger_;
+std::atomic<std::shared_ptr<spdlog::logger>> Logger::sharedLogger_;
+std::vector<std::shared_ptr<spdlog::logger>> Logger::installedLoggers_;
+std::shared_ptr<spdlog::details::thread_pool> Logger::asyncPool_;
 thread_local std::string Logger::requestId_;
+std::atomic<std::shared_ptr<AuditSink>> Logger::auditSink_;
 
 void Logger::initialize(const std::string& serviceName, const std::string& logLevel) {
     auto logger = spdlog::get(serviceName);
@@ -20,27 +25,94 @@ void Logger::initialize(const std::string& serviceName, const std::string& logLe
     auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
     
     // Create logger
-    defaultLogger_ = std::make_shared<spdlog::logger>(serviceName, console_sink);
-    defaultLogger_->set_level(spdlog::level::from_str(logLevel));
+    logger = std::make_shared<spdlog::logger>(serviceName, console_sink);
+    logger->set_level(spdlog::level::from_str(logLevel));
     
     // Set simple pattern
-    defaultLogger_->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [%l] %v");
+    logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [%l] %v");
     
     // Register as default
-    spdlog::register_logger(defaultLogger_);
-    spdlog::set_default_logger(defaultLogger_);
+    install(std::move(logger));
     
     info("Logger initialized for service: " + serviceName);
 }
 
+void Logger::initializeAsync(const std::string& serviceName, const std::string& logLevel, const AsyncOptions& options) {
+    // an earlier initialize() or initializeAsync() under this name is replaced, not just re-levelled
+    auto previous = spdlog::get(serviceName);
+    if (previous) {
+        previous->flush();
+        spdlog::drop(serviceName);
+    }
+    auto previousPool = asyncPool_;  // released on return, after the new logger is installed
+
+    std::vector<spdlog::sink_ptr> sinks;
+    if (options.console) sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+    if (!options.fileName.empty()) sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(options.fileName, options.maxFileSize, options.maxFiles));
+
+    auto policy = spdlog::async_overflow_policy::block;
+    bool fellBack = false;
+    switch (options.overflow) {
+        case OverflowPolicy::Block: break;
+        case OverflowPolicy::DropOldest: policy = spdlog::async_overflow_policy::overrun_oldest; break;
+        case OverflowPolicy::DropNewest:
+#if SPDLOG_VERSION >= 11300  // discard_new and discard_counter arrived in 1.13
+            policy = spdlog::async_overflow_policy::discard_new;
+#else
+            policy = spdlog::async_overflow_policy::overrun_oldest;
+            fellBack = true;
+#endif
+            break;
+    }
+
+    asyncPool_ = std::make_shared<spdlog::details::thread_pool>(options.queueSize, std::max<size_t>(1, options.threads));
+    std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::async_logger>(serviceName, sinks.begin(), sinks.end(), asyncPool_, policy);
+    logger->set_level(spdlog::level::from_str(logLevel));
+    logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [%l] %v");
+    logger->flush_on(spdlog::level::warn);
+
+    install(std::move(logger));
+    spdlog::flush_every(options.flushInterval);
+
+    info(fmt::format("Async logger initialized for service: {} (queue {}, {} thread(s))", serviceName, options.queueSize, options.threads));
+    if (previous) warn("Replaced the existing logger for service: " + serviceName);
+    if (fellBack) warn("spdlog older than 1.13 has no discard_new; async logger drops the oldest messages instead");
+}
+
+void Logger::install(std::shared_ptr<spdlog::logger> logger) {
+    spdlog::register_logger(logger);
+    spdlog::set_default_logger(logger);
+    installedLoggers_.push_back(logger);
+    defaultLogger_.store(logger.get(), std::memory_order_release);
+    sharedLogger_.store(std::move(logger));
+}
+
+void Logger::shutdown() {
+    defaultLogger_.store(nullptr, std::memory_order_release);
+    if (auto logger = sharedLogger_.exchange(nullptr)) logger->flush();
+    spdlog::shutdown();  // joins the flusher and the async threads; a late LOG_* on another thread reaches spdlog's error handler, not freed memory
+    asyncPool_.reset();
+}
+
+uint64_t Logger::droppedMessages() {
+    if (!asyncPool_) return 0;
+    uint64_t dropped = asyncPool_->overrun_counter();
+#if SPDLOG_VERSION >= 11300  // discard_new and discard_counter arrived in 1.13
+    dropped += asyncPool_->discard_counter();
+#endif
+    return dropped;
+}
+
+size_t Logger::queuedMessages() { return asyncPool_ ? asyncPool_->queue_size() : 0; }
+
 std::shared_ptr<spdlog::logger> Logger::get(const std::string& name) {
     if (name == "default") {
-        return defaultLogger_;  // Can be nullptr if not initialized
+        return sharedLogger_.load();  // Can be nullptr if not initialized
     }
     
     auto logger = spdlog::get(name);
     if (!logger) {
-        logger = defaultLogger_;  // Can be nullptr if not initialized
+        logger = sharedLogger_.load();  // Can be nullptr if not initialized
     }
     return logger;
 }
@@ -51,19 +123,26 @@ void Logger::setRequestId(const std::string& requestId) {
 
 std::string Logger::getRequestId() {
     if (requestId_.empty()) {
-        // Generate a new request ID
-        static thread_local std::random_device rd;
-        static thread_local std::mt19937 gen(rd());
-        static thread_local std::uniform_int_distribution<> dis(0, 15);
-        
-        std::ostringstream oss;
-        for (int i = 0; i < 32; ++i) {
-            if (i == 8 || i == 12 || i == 16 || i == 20) {
-                oss << "-";
+        // Generate a new request ID: 128 bits from a per-thread splitmix64 stream, UUID layout
+        static thread_local uint64_t state = (uint64_t(std::random_device {}()) << 32) ^ std::random_device {}() ^ uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+        auto next = []() {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        };
+        static constexpr char hex[] = "0123456789abcdef";
+        uint64_t bits[2] = {next(), next()};
+        char id[36];
+        for (int i = 0, n = 0; i < 36; ++i) {
+            if (i == 8 || i == 13 || i == 18 || i == 23) {
+                id[i] = '-';
+                continue;
             }
-            oss << std::hex << dis(gen);
+            id[i] = hex[(bits[n / 16] >> ((n % 16) * 4)) & 0xF];
+            ++n;
         }
-        requestId_ = oss.str();
+        requestId_.assign(id, sizeof(id));
     }
     return requestId_;
 }
@@ -84,19 +163,17 @@ void Logger::debug(const std::string& message) {
     get()->debug(message);
 }
 
-void Logger::logAudit(const std::string& action, const std::string& entity, 
+void Logger::setAuditSink(std::shared_ptr<AuditSink> sink) {
+    auditSink_.store(std::move(sink));
+}
+
+void Logger::logAudit(const std::string& action, const std::string& entity,
                      int entityId, int userId, const std::string& details) {
-    auto logger = get();
-    
-    std::ostringstream oss;
-    oss << "AUDIT: action=" << action 
-        << " entity=" << entity 
-        << " entity_id=" << entityId 
-        << " user_id=" << userId 
-        << " details=" << details
-        << " request_id=" << getRequestId();
-    
-    logger->info(oss.str());
+    if (auto sink = auditSink_.load()) {
+        sink->Write(action, entity, entityId, userId, details, getRequestId());
+        return;
+    }
+    LOG_INFO("AUDIT: action={} entity={} entity_id={} user_id={} details={} request_id={}", action, entity, entityId, userId, details, getRequestId());
 }
 
 }
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <fmt/format.h>
+#include "metrics.h"
+
+using DB::MetricsRegistry;
+
+namespace {
+    struct Block {
+        std::array<std::atomic<uint64_t>, MetricsRegistry::maxSlots> slots {};
+    };
+
+    enum class Kind { Counter, Histogram };
+
+    struct Definition {
+        std::string name;
+        std::string help;
+        Kind kind;
+        int slot;
+    };
+
+    struct Registry {
+        std::mutex mtx;
+        std::vector<Block *> live;
+        std::array<uint64_t, MetricsRegistry::maxSlots> retired {};  // totals of threads that have exited
+        int nextSlot {0};
+        std::vector<Definition> definitions;
+
+        Registry() {
+            definitions = {
+                {"wpsql_prepares_total", "Statements prepared.", Kind::Counter, 0},
+                {"wpsql_statement_cache_hits_total", "Prepares served from the statement cache.", Kind::Counter, 1},
+                {"wpsql_rows_stepped_total", "Result rows returned by sqlite3_step.", Kind::Counter, 2},
+                {"wpsql_bytes_bound_total", "Bytes of parameter values bound to statements.", Kind::Counter, 3},
+                {"wpsql_busy_waits_total", "Times a statement or checkpoint found the database busy.", Kind::Counter, 4},
+                {"wpsql_backup_bytes_total", "Bytes copied by online backups.", Kind::Counter, 5},
+                {"wpsql_query_latency_seconds", "Time to execute a statement up to its first row (sampled).", Kind::Histogram, 6},
+                {"wpsql_commit_latency_seconds", "Time spent in commit.", Kind::Histogram, 6 + (MetricsRegistry::nBuckets + 1)},
+                {"wpsql_transaction_duration_seconds", "Time from begin to commit or rollback.", Kind::Histogram, 6 + 2 * (MetricsRegistry::nBuckets + 1)},
+                {"wpsql_checkpoint_duration_seconds", "Time spent in wal checkpoints.", Kind::Histogram, 6 + 3 * (MetricsRegistry::nBuckets + 1)},
+            };
+            nextSlot = MetricsRegistry::librarySlots;
+        }
+
+        uint64_t Sum(int slot) {
+            uint64_t v = retired[slot];
+            for (auto b : live) v += b->slots[slot].load(std::memory_order_relaxed);
+            return v;
+        }
+
+        int Allocate(const std::string &name, const std::string &help, Kind kind, int n) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (nextSlot + n > MetricsRegistry::maxSlots) throw std::length_error(fmt::format("metrics registry full, cannot add {}", name));
+            for (auto &d : definitions) {
+                if (d.name == name) throw std::invalid_argument(fmt::format("metric {} already registered", name));
+            }
+            definitions.push_back({name, help, kind, nextSlot});
+            nextSlot += n;
+            return nextSlot - n;
+        }
+    };
+
+    Registry &GetRegistry() {
+        static auto registry = new Registry;  // never destroyed: threads may still exit after static destructors ran
+        return *registry;
+    }
+
+    Block discarded;  // takes writes from thread_local destructors that run after this thread's block was retired
+
+    struct LocalBlock {
+        Block *block {nullptr};
+        std::atomic<uint64_t> **slots {nullptr};  // this thread's MetricsRegistry::localSlots, repointed before the block goes
+        bool retired {false};
+        ~LocalBlock() {
+            if (!block) return;
+            auto &r = GetRegistry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            for (int i = 0; i < r.nextSlot; i++) r.retired[i] += block->slots[i].load(std::memory_order_relaxed);
+            r.live.erase(std::find(r.live.begin(), r.live.end(), block));
+            *slots = discarded.slots.data();
+            delete block;
+            retired = true;
+        }
+    };
+
+    thread_local LocalBlock localBlock;
+
+    double BucketBoundSeconds(int b) { return static_cast<double>(uint64_t(1) << (b + MetricsRegistry::firstBucketShift)) / 1e9; }
+}
+
+std::atomic<uint64_t> *MetricsRegistry::AttachThread() {
+    if (localBlock.retired) return localSlots = discarded.slots.data();
+    auto &r = GetRegistry();
+    localBlock.block = new Block;
+    localBlock.slots = &localSlots;
+    {
+        std::lock_guard<std::mutex> lock(r.mtx);
+        r.live.push_back(localBlock.block);
+    }
+    return localSlots = localBlock.block->slots.data();
+}
+
+uint64_t MetricsRegistry::Counter::Value() const {
+    auto &r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    return r.Sum(slot);
+}
+
+uint64_t MetricsRegistry::Histogram::Count() const {
+    auto &r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    uint64_t n = 0;
+    for (int b = 0; b < nBuckets; b++) n += r.Sum(slot + b);
+    return n;
+}
+
+double MetricsRegistry::Histogram::SumSeconds() const {
+    auto &r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    return r.Sum(slot + nBuckets) / 1e9;
+}
+
+MetricsRegistry::Counter MetricsRegistry::AddCounter(const std::string &name, const std::string &help) { return Counter(GetRegistry().Allocate(name, help, Kind::Counter, 1)); }
+
+MetricsRegistry::Histogram MetricsRegistry::AddHistogram(const std::string &name, const std::string &help) { return Histogram(GetRegistry().Allocate(name, help, Kind::Histogram, nBuckets + 1)); }
+
+void MetricsRegistry::WritePrometheus(const std::function<void(std::string_view)> &writer) {
+    auto &r = GetRegistry();
+    std::vector<std::string> blocks;
+    {
+        std::lock_guard<std::mutex> lock(r.mtx);  // the writer runs unlocked; it may be slow or record metrics itself
+        for (auto &d : r.definitions) {
+            std::string s = fmt::format("# HELP {} {}\n# TYPE {} {}\n", d.name, d.help, d.name, d.kind == Kind::Counter ? "counter" : "histogram");
+            if (d.kind == Kind::Counter) {
+                fmt::format_to(std::back_inserter(s), "{} {}\n", d.name, r.Sum(d.slot));
+            } else {
+                uint64_t cumulative = 0;
+                for (int b = 0; b < nBuckets; b++) {
+                    cumulative += r.Sum(d.slot + b);
+                    if (b < nBuckets - 1)
+                        fmt::format_to(std::back_inserter(s), "{}_bucket{{le=\"{}\"}} {}\n", d.name, BucketBoundSeconds(b), cumulative);
+                    else
+                        fmt::format_to(std::back_inserter(s), "{}_bucket{{le=\"+Inf\"}} {}\n", d.name, cumulative);
+                }
+                fmt::format_to(std::back_inserter(s), "{}_sum {}\n{}_count {}\n", d.name, r.Sum(d.slot + nBuckets) / 1e9, d.name, cumulative);
+            }
+            blocks.push_back(std::move(s));
+        }
+    }
+    for (auto &s : blocks) writer(s);
+}
+
+std::string MetricsRegistry::ToPrometheus() {
+    std::string out;
+    WritePrometheus([&out](std::string_view s) { out.append(s); });
+    return out;
+}
@@ -184,6 +184,7 @@ bool DB::SQLiteBase::IsColumnExist(wpSQLDatabase &d, const std::string &alias, c
 
 std::shared_ptr<TransactionDB> DB::SQLiteBase::GetTransactionDB() {
     auto x = std::make_shared<TransactionDB>(GetTransactionDBName(), this);
+    x->SetTuningProfile(tuningProfile);
     x->Open();
     return x;
 }
@@ -279,14 +280,19 @@ void DB::SQLiteBase::Open(bool checkAndCreate, OpenMode mode) {
     else
         toExecuteCommand = isNewDatabase = !std::filesystem::exists(_dbName);
     if (toExecuteCommand) mode = OpenMode::ReadWrite;
-    db->Open(_dbName, openMode);
+    db->Open(_dbName, openMode, _vfsName);
 
+    ApplyTuning(isNewDatabase);  // page_size must precede journal_mode=WAL on a new file
     if (journalOff)
         db->ExecuteUpdate("PRAGMA journal_mode=OFF");
-    else if (usingWAL)
-        db->ExecuteUpdate("PRAGMA journal_mode=WAL");
+    else if (usingWAL) {
+        auto journalMode = db->ExecuteScalar<std::string>("PRAGMA journal_mode=WAL");
+        if (!boost::iequals(journalMode, "wal"))  // e.g. the compressed vfs, which has no shared memory
+            LOG_WARN("{} cannot use WAL through vfs [{}]; staying in journal_mode={}", _dbName, _vfsName, journalMode);
+    }
     if (turnOffSynchronize) db->ExecuteUpdate("PRAGMA synchronous=off");
     if (exclusiveMode) db->ExecuteUpdate("PRAGMA locking_mode=EXCLUSIVE");
+    if (walCheckpointerOptions) StartWalCheckpointer(*walCheckpointerOptions);
 
     if (!isNewDatabase) {
         InitFunction();  // create userdefined functions - tables already exists;
@@ -307,7 +313,62 @@ void DB::SQLiteBase::Open(bool checkAndCreate, OpenMode mode) {
     _dropAllObjects = false;
 }
 
+DB::TuningSettings DB::TuningSettings::For(TuningProfile profile) {
+    switch (profile) {
+        //                                     mmap        cache    temp  page   walCkpt spill
+        case TuningProfile::OLTP: return {256LL << 20, -65536, 2, 4096, 1000, true};
+        case TuningProfile::BulkLoad: return {256LL << 20, -262144, 2, 16384, 10000, false};
+        case TuningProfile::ReadOnlyAnalytics: return {1LL << 30, -131072, 2, 16384, 1000, true};
+        case TuningProfile::LowMemory: return {0, -512, 1, 4096, 250, true};
+        default: return {0, -2000, 0, 0, 1000, true};  // sqlite defaults
+    }
+}
+
+std::string DB::TuningSettings::Name(TuningProfile profile) {
+    switch (profile) {
+        case TuningProfile::OLTP: return "OLTP";
+        case TuningProfile::BulkLoad: return "BulkLoad";
+        case TuningProfile::ReadOnlyAnalytics: return "ReadOnlyAnalytics";
+        case TuningProfile::LowMemory: return "LowMemory";
+        default: return "Default";
+    }
+}
+
+void DB::SQLiteBase::ApplyTuning(bool isNew) {
+    auto t = GetTuningSettings();
+    if (isNew && t.pageSize > 0) db->ExecuteUpdate(fmt::format("PRAGMA page_size={}", t.pageSize));
+    db->ExecuteUpdate(fmt::format("PRAGMA mmap_size={}", t.mmapSize));
+    db->ExecuteUpdate(fmt::format("PRAGMA cache_size={}", t.cacheSize));
+    db->ExecuteUpdate(fmt::format("PRAGMA temp_store={}", t.tempStore));
+    db->ExecuteUpdate(fmt::format("PRAGMA wal_autocheckpoint={}", walCheckpointer ? 0 : t.walAutoCheckpoint));
+    db->ExecuteUpdate(fmt::format("PRAGMA cache_spill={}", t.cacheSpill ? 1 : 0));
+}
+
+void DB::SQLiteBase::SetTuningProfile(TuningProfile profile) {
+    tuningProfile = profile;
+    if (IsOpened()) ApplyTuning(false);
+}
+
+void DB::SQLiteBase::StartWalCheckpointer(const WalCheckpointer::Options &options) {
+    if (walCheckpointer || !usingWAL || journalOff || boost::iequals(_dbName, ":memory:")) return;
+    walCheckpointerOptions = options;
+    walCheckpointer = std::make_unique<WalCheckpointer>(_dbName, options, _vfsName);
+    if (IsOpened()) {
+        db->ExecuteUpdate("PRAGMA wal_autocheckpoint=0");  // commits no longer pay for checkpoints
+        db->ExecuteUpdate(fmt::format("PRAGMA journal_size_limit={}", options.escalateBytes));  // shrink the wal file when this connection restarts it
+    }
+    walCheckpointer->Start();
+}
+
+void DB::SQLiteBase::StopWalCheckpointer() {
+    walCheckpointerOptions.reset();
+    if (!walCheckpointer) return;
+    walCheckpointer.reset();
+    if (IsOpened()) db->ExecuteUpdate(fmt::format("PRAGMA wal_autocheckpoint={}", GetTuningSettings().walAutoCheckpoint));
+}
+
 void DB::SQLiteBase::Close() {
+    walCheckpointer.reset();  // keeps walCheckpointerOptions for the next Open
     if (db->IsOpen()) {
         db->Close();
     }
@@ -541,6 +602,62 @@ auto formatNumber(sqlite3_context *ctx, int argc, sqlite3_value **data) -> void
     }
 }
 
+// ulid arguments may be the 16-byte blob or its 26-char text; false when neither
+static bool ulidArgument(sqlite3_value *v, ULID &id) {
+    if (sqlite3_value_type(v) == SQLITE_BLOB && sqlite3_value_bytes(v) == ULID::LENGTH) {
+        id = ULID(static_cast<const uint8_t *>(sqlite3_value_blob(v)));
+        return true;
+    }
+    if (sqlite3_value_type(v) == SQLITE_TEXT) {
+        std::string_view s((const char *)sqlite3_value_text(v), sqlite3_value_bytes(v));
+        return s.size() == ULID::HEX_LENGTH ? ULID::decodeHex(s, id) : ULID::decode(s, id);
+    }
+    return false;
+}
+
+static void resultULID(sqlite3_context *ctx, const ULID &id) { sqlite3_result_blob(ctx, id.data(), ULID::LENGTH, SQLITE_TRANSIENT); }
+
+// ulid() -> new id; ulid(ms) -> new id for that unix time in milliseconds
+auto ulidNew(sqlite3_context *ctx, int argc, sqlite3_value **data) -> void {
+    if (argc >= 1 && sqlite3_value_type(data[0]) != SQLITE_NULL)
+        resultULID(ctx, ULID::generate(static_cast<uint64_t>(sqlite3_value_int64(data[0]))));
+    else
+        resultULID(ctx, ULID());
+}
+
+auto ulidToText(sqlite3_context *ctx, int /*argc*/, sqlite3_value **data) -> void {
+    ULID id(ULID::empty);
+    if (!ulidArgument(data[0], id)) return sqlite3_result_null(ctx);
+    char text[ULID::STRING_LENGTH];
+    id.encode(text);
+    sqlite3_result_text(ctx, text, ULID::STRING_LENGTH, SQLITE_TRANSIENT);
+}
+
+auto ulidFromText(sqlite3_context *ctx, int /*argc*/, sqlite3_value **data) -> void {
+    ULID id(ULID::empty);
+    if (sqlite3_value_type(data[0]) != SQLITE_TEXT || !ulidArgument(data[0], id)) return sqlite3_result_null(ctx);
+    resultULID(ctx, id);
+}
+
+// unix time in milliseconds
+auto ulidTime(sqlite3_context *ctx, int /*argc*/, sqlite3_value **data) -> void {
+    ULID id(ULID::empty);
+    if (!ulidArgument(data[0], id)) return sqlite3_result_null(ctx);
+    sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(id.timestamp()));
+}
+
+// smallest/largest id of a millisecond, so "id between ulid_min_for_time(a) and ulid_max_for_time(b)" is a primary key range
+static void ulidBoundForTime(sqlite3_context *ctx, sqlite3_value *v, uint8_t fill) {
+    if (sqlite3_value_type(v) == SQLITE_NULL) return sqlite3_result_null(ctx);
+    std::array<uint8_t, ULID::LENGTH> bytes;
+    bytes.fill(fill);
+    auto ms = std::clamp<sqlite3_int64>(sqlite3_value_int64(v), 0, (1LL << 48) - 1);
+    for (int i = 5; i >= 0; --i, ms >>= 8) bytes[i] = static_cast<uint8_t>(ms & 0xFF);
+    sqlite3_result_blob(ctx, bytes.data(), ULID::LENGTH, SQLITE_TRANSIENT);
+}
+auto ulidMinForTime(sqlite3_context *ctx, int /*argc*/, sqlite3_value **data) -> void { ulidBoundForTime(ctx, data[0], 0x00); }
+auto ulidMaxForTime(sqlite3_context *ctx, int /*argc*/, sqlite3_value **data) -> void { ulidBoundForTime(ctx, data[0], 0xFF); }
+
 void DB::SQLiteBase::InitFunction() {
     ResetRegistry();
     GetSession().CreateFunction("comma", -1, concatComma);
@@ -555,6 +672,12 @@ void DB::SQLiteBase::InitFunction() {
     GetSession().CreateFunction("getdayname", 1, getDayName, this);
     GetSession().CreateFunction("removetime", 1, setTimeZero);
     GetSession().CreateFunction("formatnumber", 1, formatNumber);
+    GetSession().CreateFunction("ulid", -1, ulidNew, nullptr, false);
+    GetSession().CreateFunction("ulid_to_text", 1, ulidToText);
+    GetSession().CreateFunction("ulid_from_text", 1, ulidFromText);
+    GetSession().CreateFunction("ulid_time", 1, ulidTime);
+    GetSession().CreateFunction("ulid_min_for_time", 1, ulidMinForTime);
+    GetSession().CreateFunction("ulid_max_for_time", 1, ulidMaxForTime);
 }
 
 std::string DB::SQLiteBase::GetAllRows(const std::string &t, const std::string &sql) {
@@ -795,7 +918,11 @@ bool TransactionDB::Migrate(DB::SQLiteBase *master, std::vector<std::string> &tL
                             } else {
                                 if (divideFactor[i] > 1)
                                     sttIns->Bind(i + 1, rss->Get<double>(i) / divideFactor[i]);
-                                else
+                                else if (rss->GetColumnType(i) == SQLITE_BLOB) {  // as text a blob is cut at its first zero byte
+                                    int64_t len;
+                                    auto blob = rss->GetBlob(i, len);
+                                    sttIns->Bind(i + 1, blob, static_cast<int>(len));
+                                } else
                                     sttIns->Bind(i + 1, rss->Get(i));
                             }
                         }
@@ -61,8 +61,8 @@ std::string DB::TypeRegistry::GetValue(const std::string &key, const std::string
 
 void DB::TypeRegistry::SetValue(const std::string &key, const std::string &colName, const std::string &value) {
     auto stt = d.GetSession().PrepareStatement(fmt::format("update Types set {}=@value where id=@id", colName));
-    stt->Bind("@id", reg->GetKey(key));
-    stt->Bind("@value", value);
+    stt->Bind<"@id">(reg->GetKey(key));
+    stt->Bind<"@value">(value);
     stt->ExecuteUpdate();
 }
 
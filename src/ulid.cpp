@@ -3,42 +3,95 @@
 
 ULID ULID::empty {std::array<uint8_t, ULID::LENGTH>{0}};
 
-// Static generator for new ULIDs
-std::array<uint8_t, 16> ULID::ULIDGenerator::generate() const {
-    auto now = std::chrono::system_clock::now();
-    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch())
-                         .count();
-
-    std::array<uint8_t, 16> ulid_bytes = {};
+std::atomic<bool> ULID::process_monotonic {false};
+std::atomic<uint64_t> ULID::process_sequence {0};
 
+static inline void setTimestamp(uint8_t* bytes, uint64_t timestamp) {
     // Timestamp (48 bits = 6 bytes) - big endian
     for (int i = 5; i >= 0; --i) {
-        ulid_bytes[i] = static_cast<uint8_t>(timestamp & 0xFF);
+        bytes[i] = static_cast<uint8_t>(timestamp & 0xFF);
         timestamp >>= 8;
     }
+}
+
+// Static generator for new ULIDs
+std::array<uint8_t, 16> ULID::ULIDGenerator::generate() const {
+    std::array<uint8_t, 16> ulid_bytes = {};
+    if (process_monotonic.load(std::memory_order_relaxed)) {
+        ULID id(ulid_bytes);
+        generate(&id, 1);
+        return id.binary_data;
+    }
+    auto now = std::chrono::system_clock::now();
+    setTimestamp(ulid_bytes.data(), std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
 
     // Randomness with monotonic guarantee
     generateRandomness(ulid_bytes, now);
     return ulid_bytes;
 }
 
+void ULID::ULIDGenerator::generate(ULID* out, size_t n) const {
+    if (n == 0) return;
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    if (process_monotonic.load(std::memory_order_relaxed)) {
+        generateProcessMonotonic(out, n, timestamp);
+        return;
+    }
+    if (timestamp == last_timestamp)
+        incrementRandomness();
+    else {
+        freshRandomness();
+        last_timestamp = timestamp;
+    }
+    uint8_t prefix[6];
+    setTimestamp(prefix, timestamp);
+    for (size_t k = 0; k < n; k++) {
+        if (k > 0) incrementRandomness();
+        std::memcpy(out[k].binary_data.data(), prefix, 6);
+        std::memcpy(out[k].binary_data.data() + 6, last_randomness.data(), 10);
+    }
+}
+
+void ULID::ULIDGenerator::generateProcessMonotonic(ULID* out, size_t n, uint64_t timestamp) const {
+    // reserve n consecutive (timestamp, sequence) slots; a single 64-bit CAS keeps this lock-free everywhere,
+    // where a 128-bit atomic would need cmpxchg16b or fall back to a lock in libatomic
+    uint64_t first, last;
+    uint64_t current = process_sequence.load(std::memory_order_relaxed);
+    do {
+        first = std::max(current + 1, timestamp << 16);
+        last = first + n - 1;
+    } while (!process_sequence.compare_exchange_weak(current, last, std::memory_order_relaxed));
+
+    for (size_t k = 0; k < n; k++) {
+        uint64_t slot = first + k;
+        uint8_t* bytes = out[k].binary_data.data();
+        setTimestamp(bytes, slot >> 16);
+        bytes[6] = static_cast<uint8_t>(slot >> 8);
+        bytes[7] = static_cast<uint8_t>(slot);
+        uint64_t random = dis(gen);
+        std::memcpy(bytes + 8, &random, 8);
+    }
+}
+
 void ULID::ULIDGenerator::generateRandomness(std::array<uint8_t, 16>& ulid_bytes, const std::chrono::system_clock::time_point& now) const {
     uint64_t current_timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
 
     if (current_timestamp == last_timestamp) {
         // Same millisecond: increment last randomness for monotonic ordering
         incrementRandomness();
-        std::copy(last_randomness.begin(), last_randomness.end(),
-            ulid_bytes.begin() + 6);
     } else {
         // New millisecond: generate fresh randomness
-        for (int i = 0; i < 10; ++i) {
-            last_randomness[i] = static_cast<uint8_t>(dis(gen) & 0xFF);
-            ulid_bytes[6 + i] = last_randomness[i];
-        }
+        freshRandomness();
         last_timestamp = current_timestamp;
     }
+    std::copy(last_randomness.begin(), last_randomness.end(), ulid_bytes.begin() + 6);
+}
+
+void ULID::ULIDGenerator::freshRandomness() const {
+    // 80 bits from two draws instead of one draw per byte
+    uint64_t high = dis(gen), low = dis(gen);
+    std::memcpy(last_randomness.data(), &high, 2);
+    std::memcpy(last_randomness.data() + 2, &low, 8);
 }
 
 void ULID::ULIDGenerator::incrementRandomness() const {
@@ -48,6 +101,13 @@ void ULID::ULIDGenerator::incrementRandomness() const {
         }
     }
 }
+
+std::vector<ULID> ULID::generateBatch(size_t n) {
+    std::vector<ULID> ids(n, empty);
+    generator.generate(ids.data(), n);
+    return ids;
+}
+
 ULID::ULID(const std::string& ulid_string, bool isBinary) {
     if (ulid_string.empty()) {
         *this = empty;
@@ -58,27 +118,11 @@ ULID::ULID(const std::string& ulid_string, bool isBinary) {
         std::memcpy(binary_data.data(), to_binary(ulid_string), 16);
         return;
     }
-    if (ulid_string.length() != 26) {
+    if (ulid_string.length() != STRING_LENGTH) {
         throw std::invalid_argument("Invalid ULID string length");
     }
-
-    binary_data = {};
-    uint64_t accumulator = 0;
-    int bits_accumulated = 0;
-    int byte_index = 0;
-
-    for (int c : ulid_string) {
-        if (c < 0 || c >= 128 || DECODING[c] == -1) {
-            throw std::invalid_argument("Invalid character in ULID string");
-        }
-
-        accumulator = (accumulator << 5) | DECODING[c];
-        bits_accumulated += 5;
-
-        while (bits_accumulated >= 8 && byte_index < 16) {
-            bits_accumulated -= 8;
-            binary_data[byte_index++] = static_cast<uint8_t>((accumulator >> bits_accumulated) & 0xFF);
-        }
+    if (!decode(ulid_string, *this)) {
+        throw std::invalid_argument("Invalid character in ULID string");
     }
 }
 
@@ -87,27 +131,8 @@ ULID::ULID(const std::string& ulid_string, bool isBinary) {
  * @return 26-character ULID string
  */
 std::string ULID::toString() const {
-    std::string result;
-    result.reserve(26);
-
-    uint64_t accumulator = 0;
-    int bits_accumulated = 0;
-
-    for (uint8_t byte : binary_data) {
-        accumulator = (accumulator << 8) | byte;
-        bits_accumulated += 8;
-
-        while (bits_accumulated >= 5) {
-            bits_accumulated -= 5;
-            result.push_back(ENCODING[(accumulator >> bits_accumulated) & 0x1F]);
-        }
-    }
-
-    if (bits_accumulated > 0) {
-        result.push_back(ENCODING[(accumulator << (5 - bits_accumulated)) & 0x1F]);
-    }
-
-    result.resize(26, '0');
+    std::string result(STRING_LENGTH, '0');
+    encode(result.data());
     return result;
 }
 
@@ -145,14 +170,8 @@ uint64_t ULID::timestamp() const {
  * @return 32-character hex string
  */
 std::string ULID::toHex() const {
-    std::string result;
-    result.reserve(32);
-    const char hex_chars[] = "0123456789abcdef";
-
-    for (uint8_t byte : binary_data) {
-        result.push_back(hex_chars[byte >> 4]);
-        result.push_back(hex_chars[byte & 0x0F]);
-    }
+    std::string result(HEX_LENGTH, '0');
+    encodeHex(result.data());
     return result;
 }
 
@@ -196,17 +215,14 @@ ULID ULID::generate(uint64_t timestamp_ms) {
  * @return ULID instance
  */
 ULID ULID::fromHex(const std::string& hex_string) {
-    if (hex_string.length() != 32) {
+    if (hex_string.length() != HEX_LENGTH) {
         throw std::invalid_argument("Invalid hex string length");
     }
-
-    std::array<uint8_t, 16> binary_data;
-    for (size_t i = 0; i < 16; ++i) {
-        std::string byte_str = hex_string.substr(i * 2, 2);
-        binary_data[i] = static_cast<uint8_t>(std::stoul(byte_str, nullptr, 16));
+    ULID id(empty);
+    if (!decodeHex(hex_string, id)) {
+        throw std::invalid_argument("Invalid character in hex string");
     }
-
-    return ULID(binary_data);
+    return id;
 }
 
 /**
@@ -215,17 +231,8 @@ ULID ULID::fromHex(const std::string& hex_string) {
  * @return true if valid format
  */
 bool ULID::isValidString(const std::string& ulid_string){
-    if (ulid_string.length() != 26) {
-        return false;
-    }
-
-    for (int c : ulid_string) {
-        if (c < 0 || c >= 128 || DECODING[c] == -1) {
-            return false;
-        }
-    }
-
-    return true;
+    ULID scratch(empty);
+    return decode(ulid_string, scratch);
 }
 
 // Static member definitions
@@ -0,0 +1,198 @@
+#include <bit>
+#include "ulid.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ULID_SSE2 1
+#endif
+
+/**
+ * Base32 and hex codecs for ULID.
+ *
+ * Base32 keeps the existing layout: 25 five-bit groups taken from the most
+ * significant bit down, the 26th char carrying the last 3 bits shifted left by 2.
+ * The bit groups are cut from two big-endian 64-bit words with constant shifts
+ * (the loops unroll); with SSSE3/AVX2 the 26 alphabet lookups are done with
+ * pshufb. Hex encode uses pshufb under SSSE3, hex decode SSE2 on x86-64.
+ * Define -mssse3 / -mavx2 (or WPSQL_NATIVE_ARCH in cmake) to enable the wider paths.
+ */
+namespace {
+    inline uint64_t LoadBE64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        if constexpr (std::endian::native == std::endian::little) v = std::byteswap(v);
+        return v;
+    }
+
+    inline void StoreBE64(uint8_t* p, uint64_t v) {
+        if constexpr (std::endian::native == std::endian::little) v = std::byteswap(v);
+        std::memcpy(p, &v, 8);
+    }
+
+    constexpr char ENCODING[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+    constexpr char HEXDIGITS[] = "0123456789abcdef";
+
+    constexpr std::array<int8_t, 256> MakeBase32Table() {
+        std::array<int8_t, 256> t {};
+        for (auto& v : t) v = -1;
+        for (int i = 0; i < 32; i++) {
+            t[static_cast<uint8_t>(ENCODING[i])] = static_cast<int8_t>(i);
+            if (ENCODING[i] >= 'A') t[static_cast<uint8_t>(ENCODING[i] | 0x20)] = static_cast<int8_t>(i);
+        }
+        return t;
+    }
+    constexpr std::array<int8_t, 256> BASE32 = MakeBase32Table();
+
+    constexpr std::array<int8_t, 256> MakeHexTable() {
+        std::array<int8_t, 256> t {};
+        for (auto& v : t) v = -1;
+        for (int i = 0; i < 10; i++) t['0' + i] = static_cast<int8_t>(i);
+        for (int i = 0; i < 6; i++) t['a' + i] = t['A' + i] = static_cast<int8_t>(10 + i);
+        return t;
+    }
+    constexpr std::array<int8_t, 256> HEX = MakeHexTable();
+
+    inline void Base32Indices(const uint8_t* bytes, uint8_t* idx) {
+        uint64_t hi = LoadBE64(bytes), lo = LoadBE64(bytes + 8);
+        for (int i = 0; i < 12; i++) idx[i] = static_cast<uint8_t>((hi >> (59 - 5 * i)) & 31);
+        idx[12] = static_cast<uint8_t>(((hi & 0xF) << 1) | (lo >> 63));
+        for (int j = 0; j < 12; j++) idx[13 + j] = static_cast<uint8_t>((lo >> (58 - 5 * j)) & 31);
+        idx[25] = static_cast<uint8_t>((lo & 7) << 2);
+    }
+
+    inline void Base32Encode(const uint8_t* bytes, char* out) {
+        alignas(32) uint8_t idx[32] = {};
+        Base32Indices(bytes, idx);
+#if defined(__AVX2__)
+        const __m256i tableLo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ENCODING)));
+        const __m256i tableHi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ENCODING + 16)));
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(idx));
+        // 0..15 keep their low nibble with the top bit clear, 16..31 get the top bit set so pshufb yields 0
+        __m256i lo = _mm256_shuffle_epi8(tableLo, _mm256_adds_epu8(v, _mm256_set1_epi8(0x70)));
+        __m256i hi = _mm256_shuffle_epi8(tableHi, _mm256_sub_epi8(v, _mm256_set1_epi8(16)));
+        alignas(32) char chars[32];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(chars), _mm256_or_si256(lo, hi));
+        std::memcpy(out, chars, ULID::STRING_LENGTH);
+#elif defined(__SSSE3__)
+        const __m128i tableLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ENCODING));
+        const __m128i tableHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ENCODING + 16));
+        alignas(16) char chars[32];
+        for (int k = 0; k < 32; k += 16) {
+            __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(idx + k));
+            __m128i lo = _mm_shuffle_epi8(tableLo, _mm_adds_epu8(v, _mm_set1_epi8(0x70)));
+            __m128i hi = _mm_shuffle_epi8(tableHi, _mm_sub_epi8(v, _mm_set1_epi8(16)));
+            _mm_store_si128(reinterpret_cast<__m128i*>(chars + k), _mm_or_si128(lo, hi));
+        }
+        std::memcpy(out, chars, ULID::STRING_LENGTH);
+#else
+        for (size_t i = 0; i < ULID::STRING_LENGTH; i++) out[i] = ENCODING[idx[i]];
+#endif
+    }
+
+    inline void HexEncode(const uint8_t* bytes, char* out) {
+#if defined(__SSSE3__)
+        const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEXDIGITS));
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+        __m128i hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(v, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+#else
+        for (size_t i = 0; i < ULID::LENGTH; i++) {
+            out[2 * i] = HEXDIGITS[bytes[i] >> 4];
+            out[2 * i + 1] = HEXDIGITS[bytes[i] & 0x0F];
+        }
+#endif
+    }
+
+#if defined(ULID_SSE2)
+    // 16 hex chars -> 16 nibble values; sets the top bit of every invalid lane in bad
+    inline __m128i HexNibbles(__m128i c, __m128i& bad) {
+        __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        __m128i alpha = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+        bad = _mm_or_si128(bad, _mm_andnot_si128(_mm_or_si128(isDigit, isAlpha), _mm_set1_epi8(-1)));
+        return _mm_or_si128(_mm_and_si128(isDigit, digit), _mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+    }
+#endif
+
+    inline bool HexDecode(const char* in, uint8_t* bytes) {
+#if defined(ULID_SSE2)
+        __m128i bad = _mm_setzero_si128();
+        __m128i a = HexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), bad);
+        __m128i b = HexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), bad);
+        if (_mm_movemask_epi8(bad) != 0) return false;
+        // each 16-bit lane holds (high nibble, low nibble) in memory order
+        const __m128i lowByte = _mm_set1_epi16(0x00FF);
+        __m128i packedA = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(a, lowByte), 4), _mm_srli_epi16(a, 8));
+        __m128i packedB = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b, lowByte), 4), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), _mm_packus_epi16(packedA, packedB));
+        return true;
+#else
+        int invalid = 0;
+        for (size_t i = 0; i < ULID::LENGTH; i++) {
+            int8_t h = HEX[static_cast<uint8_t>(in[2 * i])], l = HEX[static_cast<uint8_t>(in[2 * i + 1])];
+            invalid |= h | l;
+            bytes[i] = static_cast<uint8_t>((h << 4) | l);
+        }
+        return invalid >= 0;
+#endif
+    }
+
+    inline bool Base32Decode(const char* in, uint8_t* bytes) {
+        int8_t v[ULID::STRING_LENGTH];
+        int invalid = 0;
+        for (size_t i = 0; i < ULID::STRING_LENGTH; i++) invalid |= v[i] = BASE32[static_cast<uint8_t>(in[i])];
+        if (invalid < 0) return false;
+        uint64_t hi = 0, lo = 0;
+        for (int i = 0; i < 12; i++) hi |= static_cast<uint64_t>(v[i]) << (59 - 5 * i);
+        hi |= static_cast<uint64_t>(v[12]) >> 1;
+        lo = static_cast<uint64_t>(v[12] & 1) << 63;
+        for (int j = 0; j < 12; j++) lo |= static_cast<uint64_t>(v[13 + j]) << (58 - 5 * j);
+        lo |= static_cast<uint64_t>(v[25]) >> 2;
+        StoreBE64(bytes, hi);
+        StoreBE64(bytes + 8, lo);
+        return true;
+    }
+}  // namespace
+
+void ULID::encode(char* out) const { Base32Encode(binary_data.data(), out); }
+
+void ULID::encodeHex(char* out) const { HexEncode(binary_data.data(), out); }
+
+bool ULID::decode(std::string_view s, ULID& out) {
+    if (s.size() != STRING_LENGTH) return false;
+    return Base32Decode(s.data(), out.binary_data.data());
+}
+
+bool ULID::decodeHex(std::string_view s, ULID& out) {
+    if (s.size() != HEX_LENGTH) return false;
+    return HexDecode(s.data(), out.binary_data.data());
+}
+
+char* ULID::encodeBatch(std::span<const ULID> ids, char* out, char delimiter) {
+    for (auto& id : ids) {
+        Base32Encode(id.binary_data.data(), out);
+        out += STRING_LENGTH;
+        if (delimiter) *out++ = delimiter;
+    }
+    return out;
+}
+
+char* ULID::encodeHexBatch(std::span<const ULID> ids, char* out, char delimiter) {
+    for (auto& id : ids) {
+        HexEncode(id.binary_data.data(), out);
+        out += HEX_LENGTH;
+        if (delimiter) *out++ = delimiter;
+    }
+    return out;
+}
@@ -0,0 +1,110 @@
+#include <filesystem>
+#include "walCheckpoint.h"
+#include "logging.hpp"
+
+namespace fs = std::filesystem;
+
+DB::WalCheckpointer::WalCheckpointer(const std::string &name, const Options &opt, const std::string &vfs) : dbName(name), vfsName(vfs), options(opt) {}
+
+int64_t DB::WalCheckpointer::GetWalSize() const {
+    std::error_code ec;
+    auto size = fs::file_size(dbName + "-wal", ec);
+    return ec ? 0 : static_cast<int64_t>(size);
+}
+
+int DB::WalCheckpointer::BusyHandler(void *self, int) {
+    auto checkpointer = static_cast<WalCheckpointer *>(self);
+    if (std::chrono::steady_clock::now() >= checkpointer->busyDeadline) return 0;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));  // short naps catch the gaps between write transactions
+    return 1;
+}
+
+int DB::WalCheckpointer::Checkpoint(int mode, int busyWaitMs, int &nLog, int &nCheckpointed) {
+    auto start = std::chrono::steady_clock::now();
+    busyDeadline = start + std::chrono::milliseconds(busyWaitMs);
+    int rc = sqlite3_wal_checkpoint_v2(db.GetDB(), nullptr, mode, &nLog, &nCheckpointed);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+    DB::MetricsRegistry::CheckpointDuration().Observe(elapsed);
+    metrics.lastDurationMicros = micros;
+    metrics.totalDurationMicros += micros;
+    for (auto prev = metrics.maxDurationMicros.load(); micros > prev && !metrics.maxDurationMicros.compare_exchange_weak(prev, micros);) {}
+    if (rc == SQLITE_BUSY) {
+        metrics.busyCount++;
+        DB::MetricsRegistry::BusyWaits().Add();
+    } else if (rc != SQLITE_OK) {
+        metrics.errorCount++;
+        LOG_ERROR("wal checkpoint {} failed on {}: {}", mode, dbName, sqlite3_errmsg(db.GetDB()));
+    }
+    return rc;
+}
+
+void DB::WalCheckpointer::RunOnce() {
+    std::lock_guard<std::mutex> lock(runMtx);
+    if (!db.IsOpen()) {
+        db.Open(dbName, OpenMode::ReadWrite, vfsName);
+        sqlite3_busy_handler(db.GetDB(), &BusyHandler, this);
+        std::string mode;
+        db.Execute("PRAGMA journal_mode", [&mode](int, char **val, char **) { mode = val[0] ? val[0] : ""; });  // reading the header puts the connection into wal mode
+        if (mode != "wal") LOG_WARN("wal checkpointer: {} is in {} mode", dbName, mode);
+        frameBytes = db.ExecuteScalar("PRAGMA page_size") + 24;
+    }
+    int nLog = 0, nCheckpointed = 0;
+    int rc = Checkpoint(SQLITE_CHECKPOINT_PASSIVE, 0, nLog, nCheckpointed);
+    metrics.passiveCount++;
+    auto fileBytes = GetWalSize();
+    int64_t liveBytes = nLog > 0 ? nLog * frameBytes : 0;  // the file itself only shrinks on truncate
+
+    if (liveBytes > options.capBytes) {
+        metrics.forcedCount++;
+        rc = Checkpoint(SQLITE_CHECKPOINT_TRUNCATE, options.capWaitMs, nLog, nCheckpointed);
+        if (rc == SQLITE_BUSY) LOG_WARN("wal of {} holds {:.1f} MB, over the cap; could not truncate within {}ms", dbName, liveBytes / 1048576.0, options.capWaitMs);
+    } else if (rc == SQLITE_OK && nLog > 0 && nLog == nCheckpointed && fileBytes > options.escalateBytes) {
+        rc = Checkpoint(SQLITE_CHECKPOINT_TRUNCATE, 0, nLog, nCheckpointed);  // returns busy at once if a reader is still on the wal
+    }
+    if (rc == SQLITE_OK && GetWalSize() < fileBytes) metrics.truncateCount++;
+
+    metrics.walFrames = nLog;
+    metrics.framesCheckpointed = nCheckpointed;
+    metrics.walBytes = GetWalSize();
+}
+
+void DB::WalCheckpointer::Run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopping) {
+        cv.wait_for(lock, options.interval, [this] { return stopping; });
+        if (stopping) break;
+        lock.unlock();
+        try {
+            RunOnce();
+        } catch (wpSQLException &e) {
+            metrics.errorCount++;
+            LOG_ERROR("wal checkpointer {}: {}", dbName, e.message);
+        } catch (std::exception &e) {
+            metrics.errorCount++;
+            LOG_ERROR("wal checkpointer {}: {}", dbName, e.what());
+        }
+        lock.lock();
+    }
+}
+
+void DB::WalCheckpointer::Start() {
+    if (worker.joinable()) return;
+    stopping = false;
+    worker = std::thread([this] { Run(); });
+    LOG_INFO("wal checkpointer started for {} every {}ms", dbName, options.interval.count());
+}
+
+void DB::WalCheckpointer::Stop() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+    std::lock_guard<std::mutex> lock(runMtx);
+    db.Close();
+    LOG_INFO("wal checkpointer stopped for {}: {} passive, {} truncated, {} busy, max {}us", dbName, metrics.passiveCount.load(), metrics.truncateCount.load(), metrics.busyCount.load(), metrics.maxDurationMicros.load());
+}
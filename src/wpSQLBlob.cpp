@@ -0,0 +1,138 @@
+#include <algorithm>
+#include "logging.hpp"
+#include "wpSQLBlob.h"
+
+wpSQLBlob::wpSQLBlob(std::shared_ptr<wpSQLManager> d, const std::string &table, const std::string &column, int64_t rowid, bool writable, const std::string &database) : db(std::move(d)) {
+    if (!db || !db->GetSQLite3()) throw wpSQLException("wpSQLBlob: database already closed", 0, NULL);
+    int rc = sqlite3_blob_open(db->GetSQLite3(), database.c_str(), table.c_str(), column.c_str(), rowid, writable ? 1 : 0, &blob);
+    if (rc != SQLITE_OK) {
+        sqlite3_blob_close(blob);  // sqlite may hand back a handle even on failure
+        blob = nullptr;
+        throw wpSQLException(fmt::format("wpSQLBlob: cannot open {}.{} row {}", table, column, rowid), rc, db->GetSQLite3());
+    }
+    size = sqlite3_blob_bytes(blob);
+}
+
+wpSQLBlob::~wpSQLBlob() {
+    if (blob) sqlite3_blob_close(blob);
+}
+
+void wpSQLBlob::Read(void *buffer, int n, int offset) const {
+    int rc = sqlite3_blob_read(blob, buffer, n, offset);
+    if (rc != SQLITE_OK) throw wpSQLException(fmt::format("wpSQLBlob::Read> {} bytes at {} of {}", n, offset, size), rc, db->GetSQLite3());
+}
+
+void wpSQLBlob::Write(const void *data, int n, int offset) {
+    int rc = sqlite3_blob_write(blob, data, n, offset);
+    if (rc != SQLITE_OK) throw wpSQLException(fmt::format("wpSQLBlob::Write> {} bytes at {} of {}", n, offset, size), rc, db->GetSQLite3());
+}
+
+void wpSQLBlob::Reopen(int64_t rowid) {
+    int rc = sqlite3_blob_reopen(blob, rowid);
+    if (rc != SQLITE_OK) throw wpSQLException(fmt::format("wpSQLBlob::Reopen> row {}", rowid), rc, db->GetSQLite3());
+    size = sqlite3_blob_bytes(blob);
+}
+
+static void CheckChunkSize(const char *where, int chunkSize) {
+    if (chunkSize <= 0) throw wpSQLException(fmt::format("{}> chunk size must be positive, got {}", where, chunkSize), SQLITE_MISUSE, NULL);
+}
+
+void wpSQLBlob::ForEachChunk(const std::function<void(std::span<const unsigned char>)> &fn, int chunkSize) const {
+    CheckChunkSize("wpSQLBlob::ForEachChunk", chunkSize);
+    std::vector<unsigned char> buffer(std::min(chunkSize, size));
+    for (int pos = 0; pos < size; pos += chunkSize) {
+        int n = std::min(chunkSize, size - pos);
+        Read(buffer.data(), n, pos);
+        fn(std::span<const unsigned char>(buffer.data(), n));
+    }
+}
+
+int64_t wpSQLBlob::CopyTo(std::ostream &out, int chunkSize) const {
+    int64_t copied = 0;
+    ForEachChunk([&](std::span<const unsigned char> chunk) {
+        if (!out.write(reinterpret_cast<const char *>(chunk.data()), chunk.size())) throw wpSQLException(fmt::format("wpSQLBlob::CopyTo> stream failed after {} bytes", copied), 0, NULL);
+        copied += chunk.size();
+    }, chunkSize);
+    return copied;
+}
+
+int64_t wpSQLBlob::CopyFrom(std::istream &in, int chunkSize) {
+    CheckChunkSize("wpSQLBlob::CopyFrom", chunkSize);
+    std::vector<char> buffer(std::min(chunkSize, size));
+    int pos = 0;
+    while (pos < size && in) {
+        in.read(buffer.data(), std::min(chunkSize, size - pos));
+        int n = static_cast<int>(in.gcount());
+        if (n == 0) break;
+        Write(buffer.data(), n, pos);
+        pos += n;
+    }
+    return pos;
+}
+
+wpSQLBlobBuf::wpSQLBlobBuf(std::shared_ptr<wpSQLBlob> b, int chunkSize) : blob(std::move(b)) {
+    CheckChunkSize("wpSQLBlobBuf", chunkSize);
+    buffer.resize(chunkSize);
+}
+
+wpSQLBlobBuf::~wpSQLBlobBuf() {
+    try {
+        FlushPut();
+    } catch (wpSQLException &e) {
+        LOG_ERROR("wpSQLBlobBuf: pending write lost: {}", e.message);
+    }
+}
+
+int64_t wpSQLBlobBuf::Tell() const {
+    if (eback()) return offset + (gptr() - eback());
+    if (pbase()) return offset + (pptr() - pbase());
+    return offset;
+}
+
+bool wpSQLBlobBuf::FlushPut() {
+    if (!pbase()) return true;
+    int n = static_cast<int>(pptr() - pbase());
+    setp(nullptr, nullptr);
+    if (n > 0) blob->Write(buffer.data(), n, static_cast<int>(offset));
+    offset += n;
+    return true;
+}
+
+std::streambuf::int_type wpSQLBlobBuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    int64_t pos = Tell();
+    FlushPut();
+    offset = pos;
+    int n = static_cast<int>(std::min<int64_t>(buffer.size(), blob->Size() - offset));
+    if (n <= 0) {
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+    blob->Read(buffer.data(), n, static_cast<int>(offset));
+    setg(buffer.data(), buffer.data(), buffer.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streambuf::int_type wpSQLBlobBuf::overflow(int_type c) {
+    int64_t pos = Tell();
+    setg(nullptr, nullptr, nullptr);
+    FlushPut();
+    offset = pos;
+    int n = static_cast<int>(std::min<int64_t>(buffer.size(), blob->Size() - offset));
+    if (n <= 0) return traits_type::eof();  // a blob handle cannot grow its cell
+    setp(buffer.data(), buffer.data() + n);
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+}
+
+std::streambuf::pos_type wpSQLBlobBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) {
+    int64_t base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? Tell() : blob->Size();
+    int64_t target = base + off;
+    if (target < 0 || target > blob->Size()) return pos_type(off_type(-1));
+    setg(nullptr, nullptr, nullptr);
+    FlushPut();
+    offset = target;
+    return pos_type(target);
+}
@@ -0,0 +1,596 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <zlib.h>
+#include "logging.hpp"
+#include "wpSQLCompressedVFS.h"
+
+/*
+Physical layout of a compressed main database file:
+
+  [0, 512)        file header: magic[16], pageSize u32, reserved u32, changeCounter u64
+  [512, ...)      slots, each a 20 byte header {pgno, csize, capacity, seq, checksum} followed by capacity bytes
+
+pgno 0 marks a free slot. csize == pageSize means the page did not compress and is stored raw.
+checksum is a crc32 of the other four header fields and the csize payload bytes.
+Slots start on 64 byte boundaries and their total size is a multiple of 64, so a scan that meets a
+damaged header can step to the next boundary and carry on; the checksum keeps it from taking
+compressed payload it steps through for a slot.
+When a page outgrows its slot it is written to a free or new slot with a higher seq and the old
+slot is released afterwards, so a crash in between leaves two copies and the higher seq wins.
+No slot covers [1 GiB, 1 GiB + 512), the bytes SQLite locks in the underlying file (mandatory locks
+on Windows); appends skip over them.
+The change counter is bumped when a writer that modified the file syncs or drops its write lock,
+whichever comes first, so it moves even with synchronous=off; readers compare it when taking a
+shared lock and rescan the slot headers if another connection has modified the file.
+*/
+
+namespace {
+    constexpr char fileMagic[16] = "wpSQL-zippage-2";
+    constexpr int64_t fileHeaderSize = 512;
+    constexpr int64_t changeCounterOffset = 24;
+    constexpr int64_t slotAlign = 64;
+    constexpr int64_t scanWindowSize = 1 << 20;
+    constexpr int64_t lockRangeStart = 0x40000000;  // sqlite's pending byte, followed by the reserved and shared lock bytes
+    constexpr int64_t lockRangeEnd = lockRangeStart + 512;
+
+    struct SlotHeader {
+        uint32_t pgno, csize, capacity, seq;
+        uint32_t checksum;
+    };
+    constexpr int64_t slotHeaderSize = sizeof(SlotHeader);
+    static_assert(slotHeaderSize == 20);
+
+    uint32_t SlotChecksum(const SlotHeader &h, const unsigned char *payload) {
+        auto crc = crc32(0, reinterpret_cast<const Bytef *>(&h), offsetof(SlotHeader, checksum));
+        return static_cast<uint32_t>(h.csize ? crc32(crc, payload, h.csize) : crc);  // crc32 of a null buffer restarts at 0
+    }
+
+    wpSQLCompressedVFS::Options vfsOptions;
+    sqlite3_vfs compressedVFS;
+
+    class PageStore {
+        struct Slot {
+            int64_t offset {0};
+            uint32_t csize {0}, capacity {0}, seq {0};
+        };
+        struct CacheEntry {
+            std::list<uint32_t>::iterator it;
+            std::vector<unsigned char> data;
+        };
+
+        sqlite3_file *real;
+        uint32_t pageSize {0};
+        uint32_t nPages {0};
+        uint32_t seq {0};
+        uint64_t changeCounter {0};
+        int64_t fileEnd {fileHeaderSize};
+        bool dirty {false};
+        int lockLevel {SQLITE_LOCK_NONE};
+        std::vector<Slot> slots;                     // index = pgno - 1
+        std::multimap<uint32_t, int64_t> freeSlots;  // capacity -> offset
+        std::list<uint32_t> lru;
+        std::unordered_map<uint32_t, CacheEntry> cache;
+        std::vector<unsigned char> scratch;
+        z_stream deflater {}, inflater {};
+
+        int ReadHeader(int64_t realSize);
+        int ScanSlots(int64_t realSize);
+        int BumpChangeCounter();
+        int ReadPage(uint32_t pgno, unsigned char *out);
+        int WritePage(uint32_t pgno, const unsigned char *data);
+        int ReleaseSlot(int64_t offset, uint32_t capacity);
+        const unsigned char *FromCache(uint32_t pgno);
+        void ToCache(uint32_t pgno, const unsigned char *data);
+        void DropCache(uint32_t fromPgno = 1);
+
+    public:
+        explicit PageStore(sqlite3_file *f) : real(f) {
+            deflateInit2(&deflater, vfsOptions.compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+            inflateInit2(&inflater, -MAX_WBITS);
+        }
+        ~PageStore() {
+            deflateEnd(&deflater);
+            inflateEnd(&inflater);
+        }
+        int Load();
+        int Read(void *buf, int amt, sqlite3_int64 offset);
+        int Write(const void *buf, int amt, sqlite3_int64 offset);
+        int Truncate(sqlite3_int64 size);
+        int Sync(int flags);
+        sqlite3_int64 FileSize() const { return static_cast<sqlite3_int64>(nPages) * pageSize; }
+        int Lock(int eLock);
+        int Unlock(int eLock);
+    };
+
+    int PageStore::Load() {
+        sqlite3_int64 realSize = 0;
+        int rc = real->pMethods->xFileSize(real, &realSize);
+        if (rc != SQLITE_OK || realSize == 0) return rc;
+        rc = ReadHeader(realSize);
+        return rc == SQLITE_OK ? ScanSlots(realSize) : rc;
+    }
+
+    int PageStore::ReadHeader(int64_t realSize) {
+        unsigned char header[32];
+        if (realSize < (int64_t)sizeof(header)) return SQLITE_NOTADB;
+        int rc = real->pMethods->xRead(real, header, sizeof(header), 0);
+        if (rc != SQLITE_OK) return rc;
+        if (std::memcmp(header, fileMagic, sizeof(fileMagic)) != 0) return SQLITE_NOTADB;
+        std::memcpy(&pageSize, header + 16, sizeof(pageSize));
+        std::memcpy(&changeCounter, header + changeCounterOffset, sizeof(changeCounter));
+        return SQLITE_OK;
+    }
+
+    int PageStore::ScanSlots(int64_t realSize) {
+        slots.clear();
+        freeSlots.clear();
+        DropCache();
+        nPages = 0;
+        seq = 0;
+        std::vector<unsigned char> window;
+        int64_t windowStart = 0;
+        int64_t offset = fileHeaderSize;
+        int64_t liveEnd = fileHeaderSize;
+        const int64_t maxPages = (realSize - fileHeaderSize) / slotAlign;  // every slot takes at least slotAlign bytes
+        int damaged = 0;
+        while (offset + slotHeaderSize <= realSize) {
+            if (offset >= lockRangeStart && offset < lockRangeEnd) {
+                offset = lockRangeEnd;
+                continue;
+            }
+            int64_t windowEnd = windowStart + (int64_t)window.size();
+            if (window.empty() || offset < windowStart || offset + slotHeaderSize > windowEnd) {
+                windowStart = offset;
+                int64_t limit = offset < lockRangeStart ? std::min(realSize, lockRangeStart) : realSize;  // never read the locked bytes
+                window.resize(std::min(scanWindowSize, limit - offset));
+                int rc = real->pMethods->xRead(real, window.data(), (int)window.size(), windowStart);
+                if (rc != SQLITE_OK) return rc;
+                windowEnd = windowStart + (int64_t)window.size();
+            }
+            SlotHeader h;
+            std::memcpy(&h, window.data() + (offset - windowStart), sizeof(h));
+            bool plausible = h.capacity != 0 && h.capacity <= 2 * 65536 && (slotHeaderSize + h.capacity) % slotAlign == 0 && h.csize <= h.capacity &&
+                offset + slotHeaderSize + h.capacity <= realSize && h.pgno <= maxPages;
+            if (plausible && offset + slotHeaderSize + h.csize > windowEnd && windowStart != offset) {
+                window.clear();  // payload runs past the window: reread from this slot
+                continue;
+            }
+            if (!plausible || offset + slotHeaderSize + h.csize > windowEnd || SlotChecksum(h, window.data() + (offset - windowStart + slotHeaderSize)) != h.checksum) {
+                // torn write, the gap before the locked bytes, or payload stepped into after one: try the next boundary
+                if (h.capacity != 0) damaged++;
+                offset += slotAlign;
+                continue;
+            }
+            seq = std::max(seq, h.seq);
+            if (h.pgno == 0) {
+                freeSlots.emplace(h.capacity, offset);
+            } else {
+                if (h.pgno > slots.size()) slots.resize(h.pgno);
+                auto &s = slots[h.pgno - 1];
+                if (s.offset != 0 && s.seq > h.seq) {
+                    freeSlots.emplace(h.capacity, offset);  // stale copy left by an interrupted relocation
+                } else {
+                    if (s.offset != 0) freeSlots.emplace(s.capacity, s.offset);
+                    s = Slot {offset, h.csize, h.capacity, h.seq};
+                }
+                nPages = std::max(nPages, h.pgno);
+            }
+            offset += slotHeaderSize + h.capacity;
+            liveEnd = offset;
+        }
+        if (damaged > 0) {
+            wpSQLCompressedVFS::GetStats().damagedSlots += damaged;
+            LOG_WARN("wpSQLCompressedVFS: skipped {} damaged slot headers", damaged);
+        }
+        fileEnd = liveEnd;
+        return SQLITE_OK;
+    }
+
+    const unsigned char *PageStore::FromCache(uint32_t pgno) {
+        auto it = cache.find(pgno);
+        if (it == cache.end()) return nullptr;
+        lru.splice(lru.begin(), lru, it->second.it);
+        return it->second.data.data();
+    }
+
+    void PageStore::ToCache(uint32_t pgno, const unsigned char *data) {
+        if (vfsOptions.cachePages <= 0) return;
+        auto it = cache.find(pgno);
+        if (it == cache.end()) {
+            std::vector<unsigned char> buf;
+            if ((int)cache.size() >= vfsOptions.cachePages) {  // recycle the least recently used buffer
+                auto victim = cache.find(lru.back());
+                buf = std::move(victim->second.data);
+                cache.erase(victim);
+                lru.pop_back();
+            }
+            lru.push_front(pgno);
+            it = cache.emplace(pgno, CacheEntry {lru.begin(), std::move(buf)}).first;
+        } else
+            lru.splice(lru.begin(), lru, it->second.it);
+        it->second.data.assign(data, data + pageSize);
+    }
+
+    void PageStore::DropCache(uint32_t fromPgno) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (it->first >= fromPgno) {
+                lru.erase(it->second.it);
+                it = cache.erase(it);
+            } else
+                ++it;
+        }
+    }
+
+    int PageStore::ReadPage(uint32_t pgno, unsigned char *out) {
+        if (auto p = FromCache(pgno)) {
+            std::memcpy(out, p, pageSize);
+            wpSQLCompressedVFS::GetStats().cacheHits++;
+            return SQLITE_OK;
+        }
+        if (pgno > slots.size() || slots[pgno - 1].offset == 0) {  // never written
+            std::memset(out, 0, pageSize);
+            return SQLITE_OK;
+        }
+        const auto &s = slots[pgno - 1];
+        wpSQLCompressedVFS::GetStats().pagesRead++;
+        if (s.csize == pageSize) {
+            int rc = real->pMethods->xRead(real, out, pageSize, s.offset + slotHeaderSize);
+            if (rc != SQLITE_OK) return rc;
+        } else {
+            scratch.resize(std::max<size_t>(scratch.size(), s.csize));
+            int rc = real->pMethods->xRead(real, scratch.data(), s.csize, s.offset + slotHeaderSize);
+            if (rc != SQLITE_OK) return rc;
+            inflateReset(&inflater);
+            inflater.next_in = scratch.data();
+            inflater.avail_in = s.csize;
+            inflater.next_out = out;
+            inflater.avail_out = pageSize;
+            if (inflate(&inflater, Z_FINISH) != Z_STREAM_END || inflater.avail_out != 0) {
+                LOG_ERROR("wpSQLCompressedVFS: page {} is corrupted", pgno);
+                return SQLITE_IOERR_READ;
+            }
+        }
+        ToCache(pgno, out);
+        return SQLITE_OK;
+    }
+
+    int PageStore::ReleaseSlot(int64_t offset, uint32_t capacity) {
+        SlotHeader h {0, 0, capacity, ++seq, 0};
+        h.checksum = SlotChecksum(h, nullptr);
+        int rc = real->pMethods->xWrite(real, &h, sizeof(h), offset);
+        if (rc == SQLITE_OK) freeSlots.emplace(capacity, offset);
+        return rc;
+    }
+
+    int PageStore::WritePage(uint32_t pgno, const unsigned char *data) {
+        scratch.resize(std::max<size_t>(scratch.size(), slotHeaderSize + std::max<size_t>(deflateBound(&deflater, pageSize), 2 * pageSize)));
+        unsigned char *payload = scratch.data() + slotHeaderSize;
+        deflateReset(&deflater);
+        deflater.next_in = const_cast<unsigned char *>(data);
+        deflater.avail_in = pageSize;
+        deflater.next_out = payload;
+        deflater.avail_out = static_cast<uInt>(scratch.size() - slotHeaderSize);
+        uint32_t csize = pageSize;
+        if (deflate(&deflater, Z_FINISH) == Z_STREAM_END && deflater.total_out < pageSize)
+            csize = static_cast<uint32_t>(deflater.total_out);
+        else
+            std::memcpy(payload, data, pageSize);
+
+        if (pgno > slots.size()) slots.resize(pgno);
+        Slot previous = slots[pgno - 1];
+        Slot target;
+        int64_t writeLen = slotHeaderSize + csize;
+        if (previous.offset != 0 && previous.capacity >= csize) {  // rewrite in place
+            target = previous;
+        } else if (auto it = freeSlots.lower_bound(csize); it != freeSlots.end()) {
+            target.offset = it->second;
+            target.capacity = it->first;
+            freeSlots.erase(it);
+        } else {  // append, leaving some room for the page to grow
+            uint32_t wanted = csize == pageSize ? csize : csize + csize / 8;
+            int64_t total = (slotHeaderSize + wanted + slotAlign - 1) / slotAlign * slotAlign;
+            if (fileEnd < lockRangeEnd && fileEnd + total > lockRangeStart) fileEnd = lockRangeEnd;
+            target.offset = fileEnd;
+            target.capacity = static_cast<uint32_t>(total - slotHeaderSize);
+            fileEnd += total;
+            writeLen = total;  // the whole slot must exist on disk for the next scan
+            std::memset(payload + csize, 0, target.capacity - csize);
+        }
+        target.csize = csize;
+        target.seq = ++seq;
+        SlotHeader h {pgno, csize, target.capacity, target.seq, 0};
+        h.checksum = SlotChecksum(h, payload);
+        std::memcpy(scratch.data(), &h, sizeof(h));
+        int rc = real->pMethods->xWrite(real, scratch.data(), (int)writeLen, target.offset);
+        if (rc != SQLITE_OK) return rc;
+        slots[pgno - 1] = target;
+        if (previous.offset != 0 && previous.offset != target.offset) {
+            rc = ReleaseSlot(previous.offset, previous.capacity);
+            if (rc != SQLITE_OK) return rc;
+        }
+        nPages = std::max(nPages, pgno);
+        ToCache(pgno, data);
+        auto &stats = wpSQLCompressedVFS::GetStats();
+        stats.pagesWritten++;
+        stats.bytesBeforeCompression += pageSize;
+        stats.bytesAfterCompression += csize;
+        return SQLITE_OK;
+    }
+
+    int PageStore::Read(void *buf, int amt, sqlite3_int64 offset) {
+        auto out = static_cast<unsigned char *>(buf);
+        if (pageSize == 0 || offset >= FileSize()) {
+            std::memset(out, 0, amt);
+            return SQLITE_IOERR_SHORT_READ;
+        }
+        std::vector<unsigned char> page;
+        while (amt > 0) {
+            uint32_t pgno = static_cast<uint32_t>(offset / pageSize) + 1;
+            int inPage = static_cast<int>(offset % pageSize);
+            int n = std::min<int>(amt, pageSize - inPage);
+            if (pgno > nPages) {
+                std::memset(out, 0, amt);
+                return SQLITE_IOERR_SHORT_READ;
+            }
+            if (inPage == 0 && n == (int)pageSize) {
+                int rc = ReadPage(pgno, out);
+                if (rc != SQLITE_OK) return rc;
+            } else {  // partial page, e.g. the 100 byte database header
+                page.resize(pageSize);
+                int rc = ReadPage(pgno, page.data());
+                if (rc != SQLITE_OK) return rc;
+                std::memcpy(out, page.data() + inPage, n);
+            }
+            out += n;
+            offset += n;
+            amt -= n;
+        }
+        return SQLITE_OK;
+    }
+
+    int PageStore::Write(const void *buf, int amt, sqlite3_int64 offset) {
+        if (pageSize == 0) {
+            if (offset != 0 || amt < 512 || amt > 65536 || (amt & (amt - 1)) != 0) return SQLITE_IOERR_WRITE;
+            pageSize = amt;
+            unsigned char header[fileHeaderSize] {};
+            std::memcpy(header, fileMagic, sizeof(fileMagic));
+            std::memcpy(header + 16, &pageSize, sizeof(pageSize));
+            int rc = real->pMethods->xWrite(real, header, sizeof(header), 0);
+            if (rc != SQLITE_OK) return rc;
+        }
+        if (amt != (int)pageSize || offset % pageSize != 0) {
+            LOG_ERROR("wpSQLCompressedVFS: unaligned write of {} bytes at {} (page size {})", amt, offset, pageSize);
+            return SQLITE_IOERR_WRITE;
+        }
+        dirty = true;
+        return WritePage(static_cast<uint32_t>(offset / pageSize) + 1, static_cast<const unsigned char *>(buf));
+    }
+
+    int PageStore::Truncate(sqlite3_int64 size) {
+        if (pageSize == 0) return SQLITE_OK;
+        uint32_t keep = static_cast<uint32_t>((size + pageSize - 1) / pageSize);
+        if (keep >= nPages) return SQLITE_OK;
+        dirty = true;
+        for (uint32_t pgno = keep + 1; pgno <= slots.size(); pgno++) {
+            const auto &s = slots[pgno - 1];
+            if (s.offset == 0) continue;
+            int rc = ReleaseSlot(s.offset, s.capacity);
+            if (rc != SQLITE_OK) return rc;
+        }
+        slots.resize(keep);
+        nPages = keep;
+        DropCache(keep + 1);
+        // give back the physical tail if it holds only free slots
+        int64_t liveEnd = fileHeaderSize;
+        for (const auto &s : slots)
+            if (s.offset != 0) liveEnd = std::max(liveEnd, s.offset + slotHeaderSize + s.capacity);
+        if (liveEnd < fileEnd) {
+            for (auto it = freeSlots.begin(); it != freeSlots.end();)
+                it = it->second >= liveEnd ? freeSlots.erase(it) : std::next(it);
+            int rc = real->pMethods->xTruncate(real, liveEnd);
+            if (rc != SQLITE_OK) return rc;
+            fileEnd = liveEnd;
+        }
+        return SQLITE_OK;
+    }
+
+    int PageStore::BumpChangeCounter() {
+        if (!dirty) return SQLITE_OK;
+        changeCounter++;
+        int rc = real->pMethods->xWrite(real, &changeCounter, sizeof(changeCounter), changeCounterOffset);
+        if (rc == SQLITE_OK) dirty = false;
+        return rc;
+    }
+
+    int PageStore::Sync(int flags) {
+        int rc = BumpChangeCounter();
+        return rc == SQLITE_OK ? real->pMethods->xSync(real, flags) : rc;
+    }
+
+    int PageStore::Lock(int eLock) {
+        int rc = real->pMethods->xLock(real, eLock);
+        if (rc != SQLITE_OK) return rc;
+        if (lockLevel == SQLITE_LOCK_NONE && eLock == SQLITE_LOCK_SHARED) {  // another connection may have changed the file
+            sqlite3_int64 realSize = 0;
+            rc = real->pMethods->xFileSize(real, &realSize);
+            if (rc == SQLITE_OK && realSize >= fileHeaderSize) {
+                uint64_t counter = 0;
+                rc = real->pMethods->xRead(real, &counter, sizeof(counter), changeCounterOffset);
+                if (rc == SQLITE_OK && (counter != changeCounter || pageSize == 0)) {
+                    rc = ReadHeader(realSize);
+                    if (rc == SQLITE_OK) rc = ScanSlots(realSize);
+                }
+            }
+            if (rc != SQLITE_OK) {
+                real->pMethods->xUnlock(real, SQLITE_LOCK_NONE);
+                return rc;
+            }
+        }
+        lockLevel = eLock;
+        return SQLITE_OK;
+    }
+
+    int PageStore::Unlock(int eLock) {
+        if (lockLevel >= SQLITE_LOCK_RESERVED && eLock < SQLITE_LOCK_RESERVED) {  // with synchronous=off xSync never runs
+            int rc = BumpChangeCounter();
+            if (rc != SQLITE_OK) LOG_ERROR("wpSQLCompressedVFS: cannot update the change counter rc={}", rc);
+        }
+        int rc = real->pMethods->xUnlock(real, eLock);
+        if (rc == SQLITE_OK) lockLevel = eLock;
+        return rc;
+    }
+
+    // sqlite3_file handed to SQLite; the underlying file of the root VFS follows it in memory
+    struct CompressedFile {
+        sqlite3_file base;
+        sqlite3_file *real;
+        PageStore *store;
+    };
+
+    sqlite3_file *Real(sqlite3_file *f) { return reinterpret_cast<CompressedFile *>(f)->real; }
+    PageStore *Store(sqlite3_file *f) { return reinterpret_cast<CompressedFile *>(f)->store; }
+    sqlite3_vfs *Root(sqlite3_vfs *vfs) { return static_cast<sqlite3_vfs *>(vfs->pAppData); }
+
+    int xClose(sqlite3_file *f) {
+        auto p = reinterpret_cast<CompressedFile *>(f);
+        delete p->store;
+        p->store = nullptr;
+        return p->real->pMethods ? p->real->pMethods->xClose(p->real) : SQLITE_OK;
+    }
+
+    // methods for journals, temp files and anything that is not the main database
+    int xPassRead(sqlite3_file *f, void *buf, int amt, sqlite3_int64 ofs) { return Real(f)->pMethods->xRead(Real(f), buf, amt, ofs); }
+    int xPassWrite(sqlite3_file *f, const void *buf, int amt, sqlite3_int64 ofs) { return Real(f)->pMethods->xWrite(Real(f), buf, amt, ofs); }
+    int xPassTruncate(sqlite3_file *f, sqlite3_int64 size) { return Real(f)->pMethods->xTruncate(Real(f), size); }
+    int xPassSync(sqlite3_file *f, int flags) { return Real(f)->pMethods->xSync(Real(f), flags); }
+    int xPassFileSize(sqlite3_file *f, sqlite3_int64 *size) { return Real(f)->pMethods->xFileSize(Real(f), size); }
+    int xPassLock(sqlite3_file *f, int e) { return Real(f)->pMethods->xLock(Real(f), e); }
+    int xPassUnlock(sqlite3_file *f, int e) { return Real(f)->pMethods->xUnlock(Real(f), e); }
+    int xCheckReservedLock(sqlite3_file *f, int *out) { return Real(f)->pMethods->xCheckReservedLock(Real(f), out); }
+    int xPassFileControl(sqlite3_file *f, int op, void *arg) { return Real(f)->pMethods->xFileControl(Real(f), op, arg); }
+    int xSectorSize(sqlite3_file *f) { return Real(f)->pMethods->xSectorSize(Real(f)); }
+    int xPassDeviceCharacteristics(sqlite3_file *f) { return Real(f)->pMethods->xDeviceCharacteristics(Real(f)); }
+    int xShmMap(sqlite3_file *f, int pg, int sz, int extend, void volatile **pp) { return Real(f)->pMethods->xShmMap(Real(f), pg, sz, extend, pp); }
+    int xShmLock(sqlite3_file *f, int ofs, int n, int flags) { return Real(f)->pMethods->xShmLock(Real(f), ofs, n, flags); }
+    void xShmBarrier(sqlite3_file *f) { Real(f)->pMethods->xShmBarrier(Real(f)); }
+    int xShmUnmap(sqlite3_file *f, int deleteFlag) { return Real(f)->pMethods->xShmUnmap(Real(f), deleteFlag); }
+    int xFetch(sqlite3_file *f, sqlite3_int64 ofs, int amt, void **pp) { return Real(f)->pMethods->xFetch(Real(f), ofs, amt, pp); }
+    int xUnfetch(sqlite3_file *f, sqlite3_int64 ofs, void *p) { return Real(f)->pMethods->xUnfetch(Real(f), ofs, p); }
+
+    // methods for the compressed main database
+    int xRead(sqlite3_file *f, void *buf, int amt, sqlite3_int64 ofs) { return Store(f)->Read(buf, amt, ofs); }
+    int xWrite(sqlite3_file *f, const void *buf, int amt, sqlite3_int64 ofs) { return Store(f)->Write(buf, amt, ofs); }
+    int xTruncate(sqlite3_file *f, sqlite3_int64 size) { return Store(f)->Truncate(size); }
+    int xSync(sqlite3_file *f, int flags) { return Store(f)->Sync(flags); }
+    int xFileSize(sqlite3_file *f, sqlite3_int64 *size) {
+        *size = Store(f)->FileSize();
+        return SQLITE_OK;
+    }
+    int xLock(sqlite3_file *f, int e) { return Store(f)->Lock(e); }
+    int xUnlock(sqlite3_file *f, int e) { return Store(f)->Unlock(e); }
+    int xDeviceCharacteristics(sqlite3_file *) { return 0; }  // page writes may relocate slots: promise nothing
+    int xFileControl(sqlite3_file *f, int op, void *arg) {
+        switch (op) {
+            case SQLITE_FCNTL_SIZE_HINT:
+            case SQLITE_FCNTL_CHUNK_SIZE: return SQLITE_OK;  // physical size is unrelated to the logical size
+            case SQLITE_FCNTL_MMAP_SIZE: *static_cast<sqlite3_int64 *>(arg) = 0; return SQLITE_OK;
+            case SQLITE_FCNTL_VFSNAME: {
+                int rc = xPassFileControl(f, op, arg);
+                auto name = static_cast<char **>(arg);
+                *name = rc == SQLITE_OK ? sqlite3_mprintf("%s/%z", wpSQLCompressedVFS::name, *name) : sqlite3_mprintf("%s", wpSQLCompressedVFS::name);
+                return SQLITE_OK;
+            }
+            default: return xPassFileControl(f, op, arg);
+        }
+    }
+
+    const sqlite3_io_methods passthroughMethods = {
+        3, xClose, xPassRead, xPassWrite, xPassTruncate, xPassSync, xPassFileSize, xPassLock, xPassUnlock, xCheckReservedLock,
+        xPassFileControl, xSectorSize, xPassDeviceCharacteristics, xShmMap, xShmLock, xShmBarrier, xShmUnmap, xFetch, xUnfetch};
+
+    // version 1: no shared memory (WAL) and no xFetch (memory mapping) on compressed pages
+    const sqlite3_io_methods compressedMethods = {
+        1, xClose, xRead, xWrite, xTruncate, xSync, xFileSize, xLock, xUnlock, xCheckReservedLock,
+        xFileControl, xSectorSize, xDeviceCharacteristics, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+    int xOpen(sqlite3_vfs *vfs, const char *zName, sqlite3_file *f, int flags, int *pOutFlags) {
+        auto p = reinterpret_cast<CompressedFile *>(f);
+        p->base.pMethods = nullptr;
+        p->store = nullptr;
+        p->real = reinterpret_cast<sqlite3_file *>(p + 1);
+        int rc = Root(vfs)->xOpen(Root(vfs), zName, p->real, flags, pOutFlags);
+        if (rc != SQLITE_OK) return rc;
+        if (!(flags & SQLITE_OPEN_MAIN_DB)) {
+            p->base.pMethods = &passthroughMethods;
+            return SQLITE_OK;
+        }
+        p->store = new PageStore(p->real);
+        rc = p->store->Load();
+        if (rc != SQLITE_OK) {
+            LOG_ERROR("wpSQLCompressedVFS: {} is not a compressed database", zName ? zName : "");
+            xClose(f);
+            return rc == SQLITE_NOTADB ? SQLITE_CANTOPEN : rc;
+        }
+        p->base.pMethods = &compressedMethods;
+        return SQLITE_OK;
+    }
+
+    int xDelete(sqlite3_vfs *vfs, const char *zName, int syncDir) { return Root(vfs)->xDelete(Root(vfs), zName, syncDir); }
+    int xAccess(sqlite3_vfs *vfs, const char *zName, int flags, int *pResOut) { return Root(vfs)->xAccess(Root(vfs), zName, flags, pResOut); }
+    int xFullPathname(sqlite3_vfs *vfs, const char *zName, int nOut, char *zOut) { return Root(vfs)->xFullPathname(Root(vfs), zName, nOut, zOut); }
+    void *xDlOpen(sqlite3_vfs *vfs, const char *zPath) { return Root(vfs)->xDlOpen(Root(vfs), zPath); }
+    void xDlError(sqlite3_vfs *vfs, int nByte, char *zErrMsg) { Root(vfs)->xDlError(Root(vfs), nByte, zErrMsg); }
+    void (*xDlSym(sqlite3_vfs *vfs, void *p, const char *zSym))(void) { return Root(vfs)->xDlSym(Root(vfs), p, zSym); }
+    void xDlClose(sqlite3_vfs *vfs, void *p) { Root(vfs)->xDlClose(Root(vfs), p); }
+    int xRandomness(sqlite3_vfs *vfs, int nByte, char *zOut) { return Root(vfs)->xRandomness(Root(vfs), nByte, zOut); }
+    int xSleep(sqlite3_vfs *vfs, int microseconds) { return Root(vfs)->xSleep(Root(vfs), microseconds); }
+    int xCurrentTime(sqlite3_vfs *vfs, double *p) { return Root(vfs)->xCurrentTime(Root(vfs), p); }
+    int xGetLastError(sqlite3_vfs *vfs, int n, char *z) { return Root(vfs)->xGetLastError(Root(vfs), n, z); }
+    int xCurrentTimeInt64(sqlite3_vfs *vfs, sqlite3_int64 *p) { return Root(vfs)->xCurrentTimeInt64(Root(vfs), p); }
+}  // namespace
+
+wpSQLCompressedVFS::Stats &wpSQLCompressedVFS::GetStats() {
+    static Stats stats;
+    return stats;
+}
+
+int wpSQLCompressedVFS::Register(const Options &options, bool makeDefault) {
+    static std::once_flag registered;
+    static int rc = SQLITE_OK;
+    std::call_once(registered, [&]() {
+        sqlite3_vfs *root = sqlite3_vfs_find(nullptr);
+        if (!root) {
+            rc = SQLITE_ERROR;
+            return;
+        }
+        vfsOptions = options;
+        compressedVFS = sqlite3_vfs {};
+        compressedVFS.iVersion = 2;
+        compressedVFS.szOsFile = static_cast<int>(sizeof(CompressedFile)) + root->szOsFile;
+        compressedVFS.mxPathname = root->mxPathname;
+        compressedVFS.zName = name;
+        compressedVFS.pAppData = root;
+        compressedVFS.xOpen = xOpen;
+        compressedVFS.xDelete = xDelete;
+        compressedVFS.xAccess = xAccess;
+        compressedVFS.xFullPathname = xFullPathname;
+        compressedVFS.xDlOpen = xDlOpen;
+        compressedVFS.xDlError = xDlError;
+        compressedVFS.xDlSym = xDlSym;
+        compressedVFS.xDlClose = xDlClose;
+        compressedVFS.xRandomness = xRandomness;
+        compressedVFS.xSleep = xSleep;
+        compressedVFS.xCurrentTime = xCurrentTime;
+        compressedVFS.xGetLastError = xGetLastError;
+        compressedVFS.xCurrentTimeInt64 = xCurrentTimeInt64;
+        rc = sqlite3_vfs_register(&compressedVFS, makeDefault ? 1 : 0);
+        if (rc != SQLITE_OK) LOG_ERROR("wpSQLCompressedVFS: register failed rc={}", rc);
+    });
+    return rc;
+}
@@ -9,6 +9,8 @@
 #include <boost/tokenizer.hpp>
 #include "logging.hpp"
 #include "wpSQLDatabase.h"
+#include "wpSQLBlob.h"
+#include "wpSQLCompressedVFS.h"
 
 std::string BuildFTSSearch(const std::string& param) {
     std::string res, delim;
@@ -88,24 +90,102 @@ const void *GetSQLFunctionParamBlob(sqlite3_value *data, int &len) {
 }
 
 wpSQLManager::~wpSQLManager() {
+    ClearStatementCache();
+    advisor.reset();
+    profiler.reset();
     sqlite3_close_v2(db);
     db = NULL;
 }
 
+sqlite3_stmt *wpSQLManager::TakeCachedStatement(std::string_view sql, wpSQLStatementIndex &index, StatementKey *&key) {
+    key = nullptr;
+    if (cacheCapacity == 0) return nullptr;
+    auto it = statements.find(sql);
+    if (it == statements.end()) it = statements.emplace(std::string(sql), SqlEntry()).first;
+    key = &*it;
+    key->second.outstanding++;
+    auto &idle = key->second.idle;
+    if (idle.empty()) return nullptr;
+    auto node = idle.back();
+    idle.pop_back();
+    auto stmt = node->stmt;
+    index = std::move(node->index);
+    spare.splice(spare.begin(), lru, node);
+    idleCount--;
+    return stmt;
+}
+
+void wpSQLManager::ReleaseStatement(StatementKey *key, sqlite3_stmt *stmt, wpSQLStatementIndex &&index) {
+    if (!key || !stmt || cacheCapacity == 0 || !db) {
+        sqlite3_finalize(stmt);
+        if (key) {
+            key->second.outstanding--;
+            Forget(key);
+        }
+        return;
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (idleCount >= cacheCapacity) EvictOldest();  // before outstanding drops, so this key cannot be forgotten under us
+    key->second.outstanding--;
+    if (spare.empty()) spare.emplace_back();
+    lru.splice(lru.begin(), spare, spare.begin());
+    lru.front() = {stmt, std::move(index), &key->first};
+    key->second.idle.push_back(lru.begin());
+    idleCount++;
+}
+
+void wpSQLManager::EvictOldest() {
+    auto node = std::prev(lru.end());
+    auto &entry = *statements.find(*node->sql);
+    std::erase(entry.second.idle, node);
+    sqlite3_finalize(node->stmt);
+    node->index = {};
+    spare.splice(spare.begin(), lru, node);
+    idleCount--;
+    Forget(&entry);
+}
+
+void wpSQLManager::Forget(StatementKey *key) {
+    if (key->second.idle.empty() && key->second.outstanding == 0) statements.erase(statements.find(key->first));
+}
+
+void wpSQLManager::SetStatementCacheCapacity(size_t capacity) {
+    cacheCapacity = capacity;
+    while (idleCount > cacheCapacity) EvictOldest();
+}
+
+void wpSQLManager::ClearStatementCache() {
+    while (idleCount > 0) EvictOldest();
+    spare.clear();
+}
+
 // wpSQLResultSet::~wpSQLResultSet() {
 //	if (toFinalize) sqlite3_finalize(stmt);
 // }
 
 wpSQLResultSet::wpSQLResultSet(std::shared_ptr<wpSQLStatementManager> s, bool is_eof, bool is_first)
+  : owner(s),
+    stmt(s.get()),
+    isEOF(is_eof),
+    isFirst(is_first) {
+    nCols = sqlite3_column_count(stmt->GetStatement());
+}
+
+wpSQLResultSet::wpSQLResultSet(wpSQLStatementManager *s, bool is_eof, bool is_first)
   : stmt(s),
     isEOF(is_eof),
     isFirst(is_first) {
     nCols = sqlite3_column_count(stmt->GetStatement());
-    char *p = sqlite3_expanded_sql(stmt->GetStatement());
-    if (p) {
-        pSQL = p;
+}
+
+std::string wpSQLResultSet::GetSQL() const {
+    std::string sql;
+    if (char *p = sqlite3_expanded_sql(stmt->GetStatement())) {
+        sql = p;
         sqlite3_free(p);
     }
+    return sql;
 }
 
 bool wpSQLResultSet::NextRow() {
@@ -119,18 +199,95 @@ bool wpSQLResultSet::NextRow() {
     if (rc == SQLITE_DONE) {
         isEOF = true;
         return false;
-    } else if (rc == SQLITE_ROW)
+    } else if (rc == SQLITE_ROW) {
+        DB::MetricsRegistry::RowsStepped().Add();
         return true;
+    }
     else
         throw wpSQLException("resultset:nextrow error: ", rc, stmt->GetSQLite3());
 }
 
-int wpSQLResultSet::GetColumnIndex(const std::string &colName) const {
-    if (!colName.empty()) {
-        for (int i = 0; i < nCols; i++)
-            if (boost::iequals(colName, sqlite3_column_name(stmt->GetStatement(), i)) == 0) return i;
+std::string_view wpSQLResultSet::Intern(int i) const {
+    auto text = reinterpret_cast<const char *>(sqlite3_column_text(stmt->GetStatement(), i));
+    if (!text) return {};
+    if (!arena) arena = std::make_unique<wpSQLStringArena>();
+    return arena->Intern(std::string_view(text, sqlite3_column_bytes(stmt->GetStatement(), i)));
+}
+
+namespace {
+    inline unsigned char Lower(unsigned char c) { return c >= 'A' && c <= 'Z' ? c + 32 : c; }
+
+    // length plus the first, middle and last bytes: cheaper than hashing every byte, and column names are
+    // short and few next to the table, which has at least twice as many slots
+    inline size_t NoCaseHash(std::string_view s) {
+        if (s.empty()) return 0;
+        return s.size() * 2654435761u + Lower(s.front()) * 40503u + Lower(s[s.size() / 2]) * 131u + Lower(s.back());
+    }
+
+    template<bool NoCase> inline bool SameName(std::string_view a, std::string_view b) {
+        if constexpr (!NoCase) return a == b;
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++)
+            if (Lower(a[i]) != Lower(b[i])) return false;
+        return true;
+    }
+
+    using NameSlots = std::vector<std::pair<std::string, int>>;
+
+    // names first..last, nameOf(i) null for an unnamed one; a duplicated name keeps its first index
+    template<bool NoCase, typename NameOf> void FillSlots(NameSlots &slots, int first, int last, NameOf nameOf) {
+        size_t size = 4;
+        while (size < size_t(last - first + 1) * 2) size *= 2;
+        slots.assign(size, {std::string(), -1});
+        for (int i = first; i <= last; i++) {
+            const char *name = nameOf(i);
+            if (!name) continue;
+            for (size_t slot = NoCaseHash(name) & (size - 1);; slot = (slot + 1) & (size - 1)) {
+                auto &[key, index] = slots[slot];
+                if (index < 0) {
+                    key = name;
+                    index = i;
+                    break;
+                }
+                if (SameName<NoCase>(key, name)) break;
+            }
+        }
+    }
+
+    template<bool NoCase> int FindSlot(const NameSlots &slots, std::string_view name) {
+        const size_t mask = slots.size() - 1;
+        for (size_t slot = NoCaseHash(name) & mask;; slot = (slot + 1) & mask) {
+            auto &[key, index] = slots[slot];
+            if (index < 0) return -1;
+            if (SameName<NoCase>(key, name)) return index;
+        }
     }
-    return -1;
+}
+
+// built on the first lookup by name and again after a reprepare
+int wpSQLStatementIndex::GetColumnIndex(sqlite3_stmt *stmt, std::string_view name) {
+    int prepare = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_REPREPARE, 0);
+    if (columnsPrepare != prepare) {
+        FillSlots<true>(columns, 0, sqlite3_column_count(stmt) - 1, [stmt](int i) { return sqlite3_column_name(stmt, i); });
+        columnsPrepare = prepare;
+    }
+    return FindSlot<true>(columns, name);
+}
+
+// instead of sqlite3_bind_parameter_index's scan of every parameter per call
+int wpSQLStatementIndex::GetParamIndex(sqlite3_stmt *stmt, std::string_view name) {
+    int prepare = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_REPREPARE, 0);
+    if (paramsPrepare != prepare) {
+        FillSlots<false>(params, 1, sqlite3_bind_parameter_count(stmt), [stmt](int i) { return sqlite3_bind_parameter_name(stmt, i); });  // plain ? has no name
+        paramsPrepare = prepare;
+    }
+    return std::max(FindSlot<false>(params, name), 0);
+}
+
+int wpSQLResultSet::ColumnIndex(std::string_view name) const {
+    int i = stmt->GetColumnIndex(name);
+    if (i < 0) throw wpSQLException(fmt::format("wpSQLResultSet> no column {} in [{}]", name, GetSQL()), 0, NULL);
+    return i;
 }
 
 int wpSQLResultSet::GetColumnType(int i) const {
@@ -151,12 +308,18 @@ void wpSQLStatement::Reset() {
 }
 
 std::shared_ptr<wpSQLResultSet> wpSQLStatement::Execute() {
+    return std::make_shared<wpSQLResultSet>(stmt, !Step(), true);  // resultset won't finalize statement; it's wpSQLStatement to finalize;
+}
+
+bool wpSQLStatement::Step() {
+    DB::MetricsRegistry::ScopedTimer timer(DB::MetricsRegistry::QueryLatency(), DB::MetricsRegistry::QueryLatencySampling());
+    if (needReset) Reset();
     int rc = sqlite3_step(stmt->GetStatement());
     needReset = true;
-    if (rc == SQLITE_DONE) {                                        // no more rows
-        return std::make_shared<wpSQLResultSet>(stmt, true, true);  // resultset won't finalize statement; it's wpSQLStatement to finalize;
-    } else if (rc == SQLITE_ROW) {                                  // one or more rows
-        return std::make_shared<wpSQLResultSet>(stmt, false, true);
+    if (rc == SQLITE_DONE) {  // no more rows
+        return false;
+    } else if (rc == SQLITE_ROW) {  // one or more rows
+        return true;
     } else {
         std::string sql(sqlite3_sql(stmt->GetStatement()));
         sqlite3_reset(stmt->GetStatement());
@@ -165,6 +328,7 @@ std::shared_ptr<wpSQLResultSet> wpSQLStatement::Execute() {
 }
 
 int wpSQLStatement::ExecuteUpdate() {
+    DB::MetricsRegistry::ScopedTimer timer(DB::MetricsRegistry::QueryLatency(), DB::MetricsRegistry::QueryLatencySampling());
     needReset = true;
     int rc = sqlite3_step(stmt->GetStatement());
     if (rc == SQLITE_DONE) {
@@ -182,10 +346,10 @@ int wpSQLStatement::ExecuteUpdate() {
     }
 }
 
-int wpSQLStatement::GetParamIndex(const std::string &name, bool throwIfError) const {
-    int rc = sqlite3_bind_parameter_index(stmt->GetStatement(), name.c_str());
+int wpSQLStatement::GetParamIndex(std::string_view name, bool throwIfError) const {
+    int rc = stmt->GetParamIndex(name);
     if (rc <= 0 && throwIfError) {
-        throw wpSQLException(fmt::format("wpSQLStatement::GetParamIndex> invalid parameter {} for [{}]", name, pSQL), 0, stmt->GetSQLite3());
+        throw wpSQLException(fmt::format("wpSQLStatement::GetParamIndex> invalid parameter {} for [{}]", name, GetSQL()), 0, stmt->GetSQLite3());
     }
     return rc;
 }
@@ -195,6 +359,7 @@ extern int secPerSleep;
 
 bool wpSQLDatabase::Begin() {
     Execute("begin immediate transaction", NULL);
+    if (DB::MetricsRegistry::IsEnabled()) db->txStart = std::chrono::steady_clock::now();
     //Execute("begin transaction", NULL);
     return true;
 
@@ -216,28 +381,45 @@ bool wpSQLDatabase::Begin() {
 }
 
 void wpSQLDatabase::Commit() {
-    Execute("commit transaction", NULL);
+    {
+        DB::MetricsRegistry::ScopedTimer timer(DB::MetricsRegistry::CommitLatency());
+        Execute("commit transaction", NULL);
+    }
+    EndTransaction();
     //	beginMutex.Unlock();
 }
 
+void wpSQLDatabase::EndTransaction() {
+    if (db->txStart == std::chrono::steady_clock::time_point()) return;
+    DB::MetricsRegistry::TransactionDuration().Observe(std::chrono::steady_clock::now() - db->txStart);
+    db->txStart = {};
+}
+
 bool wpSQLDatabase::IsAutoCommit() {
     return IsOpen() ? sqlite3_get_autocommit(GetDB()) != 0 : false;
 }
 
-sqlite3_stmt *wpSQLDatabase::Prepare(const std::string &sql) {
+std::shared_ptr<wpSQLStatementManager> wpSQLDatabase::Prepare(const std::string &sql) {
     if (!GetDB()) throw wpSQLException("database already closed", 0, NULL);
+    wpSQLStatementIndex index;
+    wpSQLManager::StatementKey *key;
+    if (auto cached = db->TakeCachedStatement(sql, index, key)) {
+        DB::MetricsRegistry::StatementCacheHits().Add();
+        return std::make_shared<wpSQLStatementManager>(db, cached, key, std::move(index));
+    }
     const char *tail = 0;
     sqlite3_stmt *stmt;
 
     int rc = sqlite3_prepare_v2(GetDB(), sql.c_str(), -1, &stmt, &tail);
 
-    if (!stmt) {
-        throw wpSQLException(fmt::format("Error preparing {} null pointer!", sql), rc, GetDB());
-    }
-    if (rc != SQLITE_OK) {
-        throw wpSQLException(fmt::format("Error preparing {}", sql), rc, GetDB());
+    if (!stmt || rc != SQLITE_OK) {
+        wpSQLException e(fmt::format("Error preparing {}{}", sql, stmt ? "" : " null pointer!"), rc, GetDB());
+        db->ReleaseStatement(key, stmt, {});  // finalizes, and lets go of the cache key
+        throw e;
     }
-    return stmt;
+    DB::MetricsRegistry::Prepares().Add();
+    if (auto advisor = db->GetQueryAdvisor()) advisor->Inspect(stmt);
+    return std::make_shared<wpSQLStatementManager>(db, stmt, key);
 }
 
 std::vector<std::string> wpSQLDatabase::GetAllActivePreparedStatement() {
@@ -263,6 +445,7 @@ int wpSQLDatabase::GetNumberOfActivePreparedStatement() {
 }
 
 void wpSQLDatabase::FinalizeAllStatements() {
+    db->ClearStatementCache();
     sqlite3_stmt *p = NULL;
     for (; true;) {
         p = sqlite3_next_stmt(db->GetSQLite3(), p);
@@ -273,13 +456,13 @@ void wpSQLDatabase::FinalizeAllStatements() {
 }
 
 std::shared_ptr<wpSQLStatement> wpSQLDatabase::PrepareStatement(const std::string &sql) {
-    auto stmt = std::make_shared<wpSQLStatementManager>(db, Prepare(sql));
-    return std::make_shared<wpSQLStatement>(stmt);
+    return std::make_shared<wpSQLStatement>(Prepare(sql));
 }
 
 std::shared_ptr<wpSQLResultSet> wpSQLDatabase::Execute(const std::string &sql) {
     if (!GetDB()) throw wpSQLException("database already closed", 0, NULL);
-    auto stmt = std::make_shared<wpSQLStatementManager>(db, Prepare(sql));
+    DB::MetricsRegistry::ScopedTimer timer(DB::MetricsRegistry::QueryLatency(), DB::MetricsRegistry::QueryLatencySampling());
+    auto stmt = Prepare(sql);
     for (int i = 0; true; i++) {
         int rc = sqlite3_step(stmt->GetStatement());
 
@@ -288,6 +471,7 @@ std::shared_ptr<wpSQLResultSet> wpSQLDatabase::Execute(const std::string &sql) {
         else if (rc == SQLITE_ROW)
             return std::make_shared<wpSQLResultSet>(stmt, false, true);
         else if (rc == SQLITE_BUSY) {
+            DB::MetricsRegistry::BusyWaits().Add();
             if (IsAutoCommit() || boost::icontains(sql, "commit")) {
                 if (i >= noOfWaitingIteration) {
                     auto v = fmt::format("Lock: not freed after {} sec", (noOfWaitingIteration * secPerSleep));
@@ -303,6 +487,7 @@ std::shared_ptr<wpSQLResultSet> wpSQLDatabase::Execute(const std::string &sql) {
 int wpSQLDatabase::Execute(const std::string &sql, std::function<void(int, char **, char **)> fn) {
     //std::cout << "wpSQL:execute: " << sql << std::endl;
     if (!GetDB()) throw wpSQLException("database already closed", 0, NULL);
+    DB::MetricsRegistry::ScopedTimer timer(DB::MetricsRegistry::QueryLatency(), DB::MetricsRegistry::QueryLatencySampling());
     char *zErrMsg = NULL;
     int rc = 0;
     for (int i = 0; true; i++) {
@@ -312,6 +497,7 @@ int wpSQLDatabase::Execute(const std::string &sql, std::function<void(int, char
             rc = sqlite3_exec(GetDB(), sql.c_str(), NULL, NULL, &zErrMsg);
         if (rc == SQLITE_OK) break;
         else if (rc == SQLITE_BUSY) {
+            DB::MetricsRegistry::BusyWaits().Add();
             if (IsAutoCommit() || boost::icontains(sql, "commit") || boost::icontains(sql, "begin")) {
                 if (i >= noOfWaitingIteration) {
                     auto v = fmt::format("Lock: not freed after {} sec. Error = {}", (noOfWaitingIteration * secPerSleep), (zErrMsg ? zErrMsg : ""));
@@ -373,11 +559,13 @@ bool wpSQLDatabase::HasPrimaryKey(const std::string &tabName) {
 extern int waitPerSlice; // ms
 extern int waitingFunction(void *, int nCall);
 
-void wpSQLDatabase::Open(const std::string &fileName, OpenMode mode) {  // one minute wait lock by default
+void wpSQLDatabase::Open(const std::string &fileName, OpenMode mode, const std::string &vfsName) {  // one minute wait lock by default
     if (GetDB()) Close();
+    if (vfsName == wpSQLCompressedVFS::name || (boost::istarts_with(fileName, "file:") && boost::icontains(fileName, fmt::format("vfs={}", wpSQLCompressedVFS::name))))
+        wpSQLCompressedVFS::Register();
     sqlite3 *d;
-    int flags = SQLITE_OPEN_NOMUTEX | (mode == OpenMode::ReadWrite ? (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE) : SQLITE_OPEN_READONLY);
-    int rc = sqlite3_open_v2(fileName.c_str(), &d, flags, NULL);
+    int flags = SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_URI | (mode == OpenMode::ReadWrite ? (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE) : SQLITE_OPEN_READONLY);
+    int rc = sqlite3_open_v2(fileName.c_str(), &d, flags, vfsName.empty() ? NULL : vfsName.c_str());
     if (rc != SQLITE_OK) {
         LOG_ERROR("wpSQLDatabase::Open -> {} failed to open", fileName);
         throw wpSQLException(fmt::format("{} failed to open", fileName), rc, d);
@@ -388,10 +576,46 @@ void wpSQLDatabase::Open(const std::string &fileName, OpenMode mode) {  // one m
     if (mode == OpenMode::ReadWrite) Execute("PRAGMA encoding = \"UTF-16\"", NULL);
 }
 
+std::shared_ptr<wpSQLBlob> wpSQLDatabase::OpenBlob(const std::string &table, const std::string &column, int64_t rowid, bool writable, const std::string &database) {
+    return std::make_shared<wpSQLBlob>(db, table, column, rowid, writable, database);
+}
+
+void wpSQLDatabase::EnableStatementCache(size_t capacity) {
+    if (!IsOpen()) throw wpSQLException("EnableStatementCache: database is not opened", SQLITE_MISUSE, NULL);
+    db->SetStatementCacheCapacity(capacity);
+}
+
+void wpSQLDatabase::EnableProfiler(std::chrono::milliseconds slowQueryThreshold) {
+    if (!IsOpen()) throw wpSQLException("EnableProfiler: database is not opened", SQLITE_MISUSE, NULL);
+    if (auto profiler = db->GetProfiler())
+        profiler->SetSlowQueryThreshold(slowQueryThreshold);
+    else
+        db->SetProfiler(std::make_unique<wpSQLProfiler>(GetDB(), slowQueryThreshold));
+}
+
+void wpSQLDatabase::DisableProfiler() {
+    if (db) db->SetProfiler(nullptr);
+}
+
+std::string wpSQLDatabase::DumpProfile(wpSQLProfiler::SortBy sortBy, size_t limit) {
+    auto profiler = GetProfiler();
+    return profiler ? profiler->DumpProfile(sortBy, limit) : std::string();
+}
+
+void wpSQLDatabase::EnableQueryAdvisor(bool persist) {
+    if (!IsOpen()) throw wpSQLException("EnableQueryAdvisor: database is not opened", SQLITE_MISUSE, NULL);
+    if (!db->GetQueryAdvisor()) db->SetQueryAdvisor(std::make_unique<wpSQLQueryAdvisor>(GetDB(), persist));
+}
+
+void wpSQLDatabase::DisableQueryAdvisor() {
+    if (db) db->SetQueryAdvisor(nullptr);
+}
+
 void wpSQLDatabase::Rollback(const std::string &checkPoint) {
-    if (checkPoint.empty())
+    if (checkPoint.empty()) {
         ExecuteUpdate("rollback transaction");
-    else
+        EndTransaction();
+    } else
         ExecuteUpdate(fmt::format("rollback transaction to savepoint :{}", checkPoint));
 }
 
@@ -408,6 +632,7 @@ bool wpSQLDatabase::TableExists(const std::string &tableName, const std::string
 }
 
 int wpSQLDatabase::callback(void *fnLambda, int argc, char **argv, char **azColName) {
+    DB::MetricsRegistry::RowsStepped().Add();
     if (fnLambda) {
         std::function<void(int, char **, char **)> fn = *(std::function<void(int, char **, char **)> *)(fnLambda);  // very dangerous; but could it be done? YES!
         fn(argc, argv, azColName);
@@ -442,13 +667,17 @@ int wpSQLDatabase::BackupTo(const std::string &backupName, std::function<bool()>
     sqlite3 *backupDB;
     sqlite3_backup *backupHandle;
 
-    rc = sqlite3_open(backupName.c_str(), &backupDB);
+    rc = sqlite3_open_v2(backupName.c_str(), &backupDB, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI, NULL);  // backupName may be a file: URI naming a vfs
     if (rc == SQLITE_OK) {
         backupHandle = sqlite3_backup_init(backupDB, "main", GetDB(), "main");
         if (backupHandle) {
+            int64_t pageSize = ExecuteScalar("pragma page_size"), pagesDone = 0;
             do {
                 if (fnIsStopping && fnIsStopping()) break;
                 rc = sqlite3_backup_step(backupHandle, nPagesPerCall);
+                int64_t copied = sqlite3_backup_pagecount(backupHandle) - sqlite3_backup_remaining(backupHandle);
+                DB::MetricsRegistry::BackupBytes().Add((copied - pagesDone) * pageSize);
+                pagesDone = copied;
                 if (fnProgressFeedback) fnProgressFeedback(sqlite3_backup_remaining(backupHandle), sqlite3_backup_pagecount(backupHandle));
                 if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
                     sqlite3_sleep(msSleepPerCall);
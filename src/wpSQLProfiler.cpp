@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <fmt/format.h>
+#include "wpSQLProfiler.h"
+#include "logging.hpp"
+
+static int BucketOf(int64_t nanos) {
+    uint64_t v = nanos > 0 ? static_cast<uint64_t>(nanos) : 1;
+    int e = 63 - std::countl_zero(v);
+    int sub = e >= 2 ? static_cast<int>((v >> (e - 2)) & 3) : 0;
+    return std::min(e * 4 + sub, wpSQLProfiler::nBuckets - 1);
+}
+
+static int64_t BucketUpperBound(int bucket) {
+    int e = bucket / 4, sub = bucket % 4;
+    if (e < 2) return int64_t(1) << (e + 1);
+    return static_cast<int64_t>((4 + sub + 1)) << (e - 2);
+}
+
+int64_t wpSQLProfiler::Entry::Percentile(double q) const {
+    if (calls == 0) return 0;
+    int64_t rank = std::max<int64_t>(1, static_cast<int64_t>(q * calls + 0.5)), seen = 0;
+    for (int b = 0; b < nBuckets; b++) {
+        seen += histogram[b];
+        if (seen >= rank) return std::min(BucketUpperBound(b), maxNanos);
+    }
+    return maxNanos;
+}
+
+wpSQLProfiler::wpSQLProfiler(sqlite3 *d, std::chrono::milliseconds slowQueryThreshold) : db(d) {
+    SetSlowQueryThreshold(slowQueryThreshold);
+    sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, &TraceCallback, this);
+}
+
+wpSQLProfiler::~wpSQLProfiler() { sqlite3_trace_v2(db, 0, nullptr, nullptr); }
+
+int wpSQLProfiler::TraceCallback(unsigned type, void *self, void *p, void *x) {
+    auto profiler = static_cast<wpSQLProfiler *>(self);
+    auto stmt = static_cast<sqlite3_stmt *>(p);
+    if (type == SQLITE_TRACE_ROW) {
+        std::lock_guard<std::mutex> lock(profiler->mtx);
+        profiler->pendingRows[stmt]++;
+    } else if (type == SQLITE_TRACE_PROFILE)
+        profiler->OnProfile(stmt, *static_cast<sqlite3_int64 *>(x));
+    return 0;
+}
+
+void wpSQLProfiler::OnProfile(sqlite3_stmt *stmt, int64_t nanos) {
+    const char *raw = sqlite3_sql(stmt);
+    if (!raw) return;
+    int64_t fullScan = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    int64_t sorts = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+    int64_t autoIndexes = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+    int64_t vmSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto cached = statements.find(stmt);
+        if (cached == statements.end() || cached->second.rawSql != raw) {
+            if (statements.size() > 4096) statements.clear();  // finalized statements leave stale pointers behind
+            auto key = Normalize(raw);
+            auto &entry = entries[key];
+            if (entry.sql.empty()) entry.sql = key;
+            cached = statements.insert_or_assign(stmt, Cached {raw, &entry}).first;
+        }
+        auto &e = *cached->second.entry;
+        e.calls++;
+        e.totalNanos += nanos;
+        e.maxNanos = std::max(e.maxNanos, nanos);
+        e.fullScanSteps += fullScan;
+        e.sorts += sorts;
+        e.autoIndexes += autoIndexes;
+        e.vmSteps += vmSteps;
+        e.histogram[BucketOf(nanos)]++;
+        if (auto rows = pendingRows.find(stmt); rows != pendingRows.end()) {
+            e.rows += rows->second;
+            pendingRows.erase(rows);
+        }
+    }
+    if (nanos >= slowNanos) LOG_WARN("slow query {:.1f} ms (fullscan steps {}, sorts {}, autoindex {}): {}", nanos / 1e6, fullScan, sorts, autoIndexes, raw);
+}
+
+std::string wpSQLProfiler::Normalize(std::string_view sql) {
+    std::string out;
+    out.reserve(sql.size());
+    auto isWord = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || c == '?' || c == ':' || c == '@'; };  // keeps ?1 and :p1 intact
+    for (size_t i = 0; i < sql.size();) {
+        char c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i]))) i++;
+            if (!out.empty() && i < sql.size()) out.push_back(' ');
+        } else if (c == '\'') {  // string literal, '' escapes a quote
+            for (i++; i < sql.size(); i++) {
+                if (sql[i] == '\'') {
+                    if (i + 1 < sql.size() && sql[i + 1] == '\'')
+                        i++;
+                    else
+                        break;
+                }
+            }
+            i++;
+            out.push_back('?');
+        } else if ((c == 'x' || c == 'X') && i + 1 < sql.size() && sql[i + 1] == '\'' && (out.empty() || !isWord(out.back()))) {  // blob literal
+            i++;
+            continue;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) && (out.empty() || !isWord(out.back()))) {
+            while (i < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '.')) i++;
+            out.push_back('?');
+        } else if (c == '"' || c == '`' || c == '[') {  // quoted identifier, copied as is
+            char close = c == '[' ? ']' : c;
+            size_t end = sql.find(close, i + 1);
+            end = end == std::string_view::npos ? sql.size() : end + 1;
+            out.append(sql.substr(i, end - i));
+            i = end;
+        } else {
+            out.push_back(c);
+            i++;
+        }
+    }
+    return out;
+}
+
+std::vector<wpSQLProfiler::Entry> wpSQLProfiler::Snapshot(SortBy sortBy) const {
+    std::vector<Entry> list;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        list.reserve(entries.size());
+        for (auto &[sql, e] : entries) list.push_back(e);
+    }
+    auto key = [sortBy](const Entry &e) -> int64_t {
+        switch (sortBy) {
+            case SortBy::Calls: return e.calls;
+            case SortBy::P99: return e.Percentile(0.99);
+            case SortBy::MaxTime: return e.maxNanos;
+            case SortBy::Rows: return e.rows;
+            case SortBy::FullScanSteps: return e.fullScanSteps;
+            case SortBy::VMSteps: return e.vmSteps;
+            default: return e.totalNanos;
+        }
+    };
+    std::sort(list.begin(), list.end(), [&key](const Entry &a, const Entry &b) { return key(a) > key(b); });
+    return list;
+}
+
+std::string wpSQLProfiler::DumpProfile(SortBy sortBy, size_t limit) const {
+    auto list = Snapshot(sortBy);
+    std::string out = fmt::format("{:>8} {:>10} {:>9} {:>9} {:>9} {:>10} {:>10} {:>6} {:>6} {:>12}  {}\n", "calls", "total ms", "p50 ms", "p99 ms", "max ms", "rows", "fullscan", "sorts", "autoix", "vm steps", "sql");
+    for (size_t i = 0; i < list.size() && i < limit; i++) {
+        auto &e = list[i];
+        fmt::format_to(std::back_inserter(out), "{:>8} {:>10.2f} {:>9.3f} {:>9.3f} {:>9.3f} {:>10} {:>10} {:>6} {:>6} {:>12}  {}\n", e.calls, e.totalNanos / 1e6, e.Percentile(0.5) / 1e6, e.Percentile(0.99) / 1e6, e.maxNanos / 1e6, e.rows, e.fullScanSteps, e.sorts, e.autoIndexes, e.vmSteps, e.sql);
+    }
+    return out;
+}
+
+void wpSQLProfiler::Reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    statements.clear();  // cached entry pointers die with the entries
+    entries.clear();
+    pendingRows.clear();
+}
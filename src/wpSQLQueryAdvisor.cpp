@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <unordered_map>
+#include <fmt/format.h>
+#include <boost/algorithm/string.hpp>
+#include "wpSQLQueryAdvisor.h"
+#include "wpSQLProfiler.h"
+#include "logging.hpp"
+
+namespace {
+    enum class TokenKind { Ident, Literal, Param, Op, Punct };
+
+    struct Token {
+        TokenKind kind;
+        std::string text;  // identifiers unquoted
+    };
+
+    std::vector<Token> Tokenize(std::string_view sql) {
+        std::vector<Token> tokens;
+        size_t i = 0, n = sql.size();
+        auto isIdent = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || static_cast<unsigned char>(c) >= 0x80; };
+        while (i < n) {
+            char c = sql[i];
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                i++;
+            } else if (c == '-' && i + 1 < n && sql[i + 1] == '-') {
+                while (i < n && sql[i] != '\n') i++;
+            } else if (c == '/' && i + 1 < n && sql[i + 1] == '*') {
+                auto end = sql.find("*/", i + 2);
+                i = end == std::string_view::npos ? n : end + 2;
+            } else if (c == '\'') {
+                size_t j = i + 1;
+                while (j < n && !(sql[j] == '\'' && (j + 1 >= n || sql[j + 1] != '\''))) j += sql[j] == '\'' ? 2 : 1;
+                tokens.push_back({TokenKind::Literal, std::string(sql.substr(i, j + 1 - i))});
+                i = j + 1;
+            } else if (c == '"' || c == '`' || c == '[') {
+                char close = c == '[' ? ']' : c;
+                std::string text;
+                size_t j = i + 1;
+                for (; j < n; j++) {
+                    if (sql[j] == close) {
+                        if (close != ']' && j + 1 < n && sql[j + 1] == close) {
+                            text.push_back(close);
+                            j++;
+                        } else
+                            break;
+                    } else
+                        text.push_back(sql[j]);
+                }
+                tokens.push_back({TokenKind::Ident, std::move(text)});
+                i = j + 1;
+            } else if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && i + 1 < n && std::isdigit(static_cast<unsigned char>(sql[i + 1])))) {
+                size_t j = i;
+                while (j < n && (isIdent(sql[j]) || sql[j] == '.' || ((sql[j] == '+' || sql[j] == '-') && (sql[j - 1] == 'e' || sql[j - 1] == 'E')))) j++;
+                tokens.push_back({TokenKind::Literal, std::string(sql.substr(i, j - i))});
+                i = j;
+            } else if ((c == 'x' || c == 'X') && i + 1 < n && sql[i + 1] == '\'') {
+                auto end = sql.find('\'', i + 2);
+                end = end == std::string_view::npos ? n : end + 1;
+                tokens.push_back({TokenKind::Literal, std::string(sql.substr(i, end - i))});
+                i = end;
+            } else if (c == '?' || c == ':' || c == '@' || c == '$') {
+                size_t j = i + 1;
+                while (j < n && isIdent(sql[j])) j++;
+                tokens.push_back({TokenKind::Param, std::string(sql.substr(i, j - i))});
+                i = j;
+            } else if (isIdent(c)) {
+                size_t j = i;
+                while (j < n && isIdent(sql[j])) j++;
+                tokens.push_back({TokenKind::Ident, std::string(sql.substr(i, j - i))});
+                i = j;
+            } else if (c == '=' || c == '<' || c == '>' || c == '!') {
+                size_t j = i + 1;
+                if (j < n && (sql[j] == '=' || sql[j] == '>' || (c == '<' && sql[j] == '<') || (c == '>' && sql[j] == '>'))) j++;
+                tokens.push_back({TokenKind::Op, std::string(sql.substr(i, j - i))});
+                i = j;
+            } else {
+                tokens.push_back({TokenKind::Punct, std::string(1, c)});
+                i++;
+            }
+        }
+        return tokens;
+    }
+
+    bool Is(const std::vector<Token> &t, size_t i, std::string_view word) { return i < t.size() && t[i].kind == TokenKind::Ident && boost::iequals(t[i].text, word); }
+    bool IsPunct(const std::vector<Token> &t, size_t i, char c) { return i < t.size() && t[i].kind == TokenKind::Punct && t[i].text[0] == c; }
+    bool IsValue(const std::vector<Token> &t, size_t i) {
+        if (IsPunct(t, i, '-') || IsPunct(t, i, '+')) i++;
+        return i < t.size() && (t[i].kind == TokenKind::Literal || t[i].kind == TokenKind::Param || Is(t, i, "null") || Is(t, i, "true") || Is(t, i, "false"));
+    }
+
+    // [qualifier.]column at i; returns the index after the reference or i when there is none
+    size_t ColumnRef(const std::vector<Token> &t, size_t i, std::string &qualifier, std::string &column) {
+        if (i >= t.size() || t[i].kind != TokenKind::Ident) return i;
+        if (IsPunct(t, i + 1, '.') && i + 2 < t.size() && t[i + 2].kind == TokenKind::Ident) {
+            qualifier = t[i].text;
+            column = t[i + 2].text;
+            return i + 3;
+        }
+        if (IsPunct(t, i + 1, '(')) return i;  // function call
+        qualifier.clear();
+        column = t[i].text;
+        return i + 1;
+    }
+
+    int Query(sqlite3 *db, const std::string &sql, const std::vector<std::string> &params, const std::function<void(sqlite3_stmt *)> &onRow) {
+        sqlite3_stmt *stmt = nullptr;
+        int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+        if (rc != SQLITE_OK) {
+            sqlite3_finalize(stmt);
+            return rc;
+        }
+        for (size_t i = 0; i < params.size(); i++) sqlite3_bind_text(stmt, int(i + 1), params[i].c_str(), -1, SQLITE_TRANSIENT);
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+            if (onRow) onRow(stmt);
+        sqlite3_finalize(stmt);
+        return rc == SQLITE_DONE ? SQLITE_OK : rc;
+    }
+
+    std::string Text(sqlite3_stmt *stmt, int col) {
+        auto p = reinterpret_cast<const char *>(sqlite3_column_text(stmt, col));
+        return p ? std::string(p) : std::string();
+    }
+
+    void AddUnique(std::vector<std::string> &list, const std::string &col) {
+        if (std::none_of(list.begin(), list.end(), [&](const std::string &c) { return boost::iequals(c, col); })) list.push_back(col);
+    }
+}
+
+const char *wpSQLQueryAdvisor::FindingName(Finding f) {
+    switch (f) {
+        case Finding::FullScan: return "full scan";
+        case Finding::TempBTree: return "temp b-tree";
+        case Finding::AutomaticIndex: return "automatic index";
+    }
+    return "";
+}
+
+wpSQLQueryAdvisor::wpSQLQueryAdvisor(sqlite3 *d, bool p) : db(d), persist(p) {}
+
+wpSQLQueryAdvisor::~wpSQLQueryAdvisor() {
+    std::lock_guard<std::mutex> lock(mtx);
+    Persist();
+}
+
+std::vector<std::string> wpSQLQueryAdvisor::TableColumns(const std::string &table) {
+    std::vector<std::string> cols;
+    Query(db, "select name from pragma_table_info(?)", {table}, [&](sqlite3_stmt *s) { cols.push_back(Text(s, 0)); });
+    return cols;
+}
+
+std::vector<std::vector<std::string>> wpSQLQueryAdvisor::TableIndexes(const std::string &table) {
+    std::vector<std::string> names;
+    Query(db, "select name from pragma_index_list(?)", {table}, [&](sqlite3_stmt *s) { names.push_back(Text(s, 0)); });
+    std::vector<std::vector<std::string>> indexes;
+    for (auto &name : names) {
+        std::vector<std::string> cols;
+        Query(db, "select name from pragma_index_info(?) order by seqno", {name}, [&](sqlite3_stmt *s) { cols.push_back(Text(s, 0)); });
+        indexes.push_back(std::move(cols));
+    }
+    return indexes;
+}
+
+// create index statement for the given columns unless an index already leads with the first of them
+std::string wpSQLQueryAdvisor::Suggest(const std::string &table, const std::vector<std::string> &cols) {
+    if (cols.empty()) return "";
+    for (auto &index : TableIndexes(table)) {
+        if (!index.empty() && boost::iequals(index.front(), cols.front())) return "";
+    }
+    return fmt::format("create index idx_{}_{} on {}({})", table, fmt::join(cols, "_"), table, fmt::join(cols, ", "));
+}
+
+void wpSQLQueryAdvisor::Inspect(sqlite3_stmt *stmt) {
+    const char *raw = sqlite3_sql(stmt);
+    if (!raw || sqlite3_stmt_isexplain(stmt)) return;
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!seen.insert(wpSQLProfiler::Normalize(raw)).second) return;  // literals differ, plan does not
+    try {
+        std::string sql(raw);
+        std::vector<std::string> plan;
+        if (Query(db, "explain query plan " + sql, {}, [&](sqlite3_stmt *s) { plan.push_back(Text(s, 3)); }) != SQLITE_OK) return;
+
+        auto tokens = Tokenize(sql);
+        std::unordered_map<std::string, std::vector<std::string>> columnCache;
+        auto columnsOf = [&](const std::string &table) -> const std::vector<std::string> & {
+            auto key = boost::to_lower_copy(table);
+            auto it = columnCache.find(key);
+            if (it == columnCache.end()) it = columnCache.emplace(key, TableColumns(table)).first;
+            return it->second;
+        };
+        auto hasColumn = [&](const std::string &table, const std::string &col) {
+            auto &cols = columnsOf(table);
+            return std::any_of(cols.begin(), cols.end(), [&](const std::string &c) { return boost::iequals(c, col); });
+        };
+        // the plan names tables by alias when one is given: "from member m" shows up as "SCAN m"
+        auto resolve = [&](const std::string &name) -> std::string {
+            if (!columnsOf(name).empty()) return name;
+            for (size_t i = 1; i < tokens.size(); i++) {
+                if (tokens[i].kind != TokenKind::Ident || !boost::iequals(tokens[i].text, name)) continue;
+                size_t t = Is(tokens, i - 1, "as") ? i - 2 : i - 1;
+                if (t < tokens.size() && tokens[t].kind == TokenKind::Ident && !columnsOf(tokens[t].text).empty()) return tokens[t].text;
+            }
+            return "";
+        };
+        auto belongs = [&](const std::string &qualifier, const std::string &col, const std::string &table, const std::string &alias) {
+            if (!qualifier.empty() && !boost::iequals(qualifier, table) && !boost::iequals(qualifier, alias)) return false;
+            return hasColumn(table, col);
+        };
+        // columns compared against literals or parameters, equalities first then at most one range unless eqOnly
+        auto constrained = [&](const std::string &table, const std::string &alias, bool eqOnly) {
+            std::vector<std::string> eq, range;
+            for (size_t i = 0; i < tokens.size(); i++) {
+                if (Is(tokens, i, "set")) {  // assignments of an update are not constraints
+                    while (i + 1 < tokens.size() && !Is(tokens, i + 1, "where")) i++;
+                    continue;
+                }
+                std::string qualifier, col;
+                size_t next = ColumnRef(tokens, i, qualifier, col);
+                if (next == i) continue;
+                if (!belongs(qualifier, col, table, alias)) {
+                    i = next - 1;
+                    continue;
+                }
+                auto &op = next < tokens.size() ? tokens[next] : tokens.back();
+                if (next < tokens.size() && op.kind == TokenKind::Op) {
+                    if ((op.text == "=" || op.text == "==") && IsValue(tokens, next + 1))
+                        AddUnique(eq, col);
+                    else if ((op.text == "<" || op.text == ">" || op.text == "<=" || op.text == ">=") && IsValue(tokens, next + 1))
+                        AddUnique(range, col);
+                } else if (Is(tokens, next, "in") || (Is(tokens, next, "is") && IsValue(tokens, next + 1)))
+                    AddUnique(eq, col);
+                else if (Is(tokens, next, "between") || ((Is(tokens, next, "like") || Is(tokens, next, "glob")) && IsValue(tokens, next + 1)))
+                    AddUnique(range, col);
+                i = next - 1;
+            }
+            for (auto &r : range) {
+                if (eqOnly) break;
+                if (std::none_of(eq.begin(), eq.end(), [&](const std::string &c) { return boost::iequals(c, r); })) {
+                    eq.push_back(r);
+                    break;
+                }
+            }
+            return eq;
+        };
+        // plain column list of "order by"/"group by"; empty if any term is an expression
+        auto sortColumns = [&](const std::string &clause, const std::string &table, const std::string &alias) {
+            std::vector<std::string> cols;
+            for (size_t i = 0; i + 1 < tokens.size(); i++) {
+                if (!Is(tokens, i, clause) || !Is(tokens, i + 1, "by")) continue;
+                for (size_t j = i + 2; j < tokens.size();) {
+                    std::string qualifier, col;
+                    size_t next = ColumnRef(tokens, j, qualifier, col);
+                    if (next == j || !belongs(qualifier, col, table, alias)) return std::vector<std::string>();
+                    AddUnique(cols, col);
+                    while (Is(tokens, next, "asc") || Is(tokens, next, "desc") || Is(tokens, next, "collate") || Is(tokens, next, "nocase") || Is(tokens, next, "binary")) next++;
+                    if (!IsPunct(tokens, next, ',')) break;
+                    j = next + 1;
+                }
+                break;
+            }
+            return cols;
+        };
+
+        std::vector<std::pair<std::string, std::string>> planTables;  // table, alias as shown in the plan
+        std::vector<Advice> found;
+        for (auto &detail : plan) {
+            std::vector<std::string> words;
+            boost::split(words, detail, boost::is_any_of(" "), boost::token_compress_on);
+            if (words.size() >= 2 && (words[0] == "SCAN" || words[0] == "SEARCH")) {
+                size_t w = words[1] == "TABLE" ? 2 : 1;  // "SCAN TABLE t" before 3.36
+                if (w >= words.size()) continue;
+                std::string alias = words[w];
+                if (w + 2 < words.size() && words[w + 1] == "AS") alias = words[w + 2];
+                std::string table = resolve(words[w]);
+                if (table.empty() || boost::istarts_with(table, "sqlite_")) continue;  // subquery, CTE, virtual or system table
+                planTables.emplace_back(table, alias);
+                if (detail.find("AUTOMATIC") != std::string::npos) {
+                    std::vector<std::string> cols;
+                    auto open = detail.find('('), close = detail.rfind(')');
+                    if (open != std::string::npos && close != std::string::npos && close > open) {
+                        std::vector<std::string> terms;
+                        auto inner = detail.substr(open + 1, close - open - 1);
+                        boost::split(terms, inner, boost::is_any_of(" "), boost::token_compress_on);
+                        for (auto &term : terms) {
+                            auto end = term.find_first_of("=<>");
+                            if (end != std::string::npos && end > 0) AddUnique(cols, term.substr(0, end));
+                        }
+                    }
+                    found.push_back({sql, Finding::AutomaticIndex, table, detail, Suggest(table, cols)});
+                } else if (words[0] == "SCAN" && detail.find(" USING ") == std::string::npos && detail.find("VIRTUAL TABLE") == std::string::npos) {
+                    found.push_back({sql, Finding::FullScan, table, detail, Suggest(table, constrained(table, alias, false))});
+                }
+            } else if (boost::starts_with(detail, "USE TEMP B-TREE FOR")) {
+                std::string table, suggestion;
+                if (planTables.size() == 1) {
+                    auto &[t, alias] = planTables.front();
+                    table = t;
+                    auto clause = detail.find("GROUP BY") != std::string::npos ? "group" : detail.find("ORDER BY") != std::string::npos ? "order" : "";
+                    if (*clause) {
+                        auto sortCols = sortColumns(clause, t, alias);
+                        if (!sortCols.empty()) {
+                            auto cols = constrained(t, alias, true);  // a range column ahead of the sort columns would not remove the sort
+                            for (auto &c : sortCols) AddUnique(cols, c);
+                            suggestion = Suggest(t, cols);
+                        }
+                    }
+                }
+                found.push_back({sql, Finding::TempBTree, table, detail, suggestion});
+            }
+        }
+        for (auto &a : found) {
+            if (a.suggestion.empty())
+                LOG_DEBUG("query advisor: {} ({}): {}", FindingName(a.finding), a.detail, a.sql);
+            else
+                LOG_WARN("query advisor: {} ({}), consider \"{}\": {}", FindingName(a.finding), a.detail, a.suggestion, a.sql);
+            advice.push_back(std::move(a));
+        }
+    } catch (std::exception &e) {
+        LOG_ERROR("query advisor failed on {}: {}", raw, e.what());
+    }
+}
+
+void wpSQLQueryAdvisor::Flush() {
+    std::lock_guard<std::mutex> lock(mtx);
+    Persist();
+}
+
+// writes advice not yet persisted; skipped while a transaction is open so the advisor never becomes part of it
+void wpSQLQueryAdvisor::Persist() {
+    if (!persist || nPersisted >= advice.size() || !sqlite3_get_autocommit(db)) return;
+    if (!tableReady) {
+        auto sql = fmt::format(
+            "create table if not exists {}(sql text not null, finding text not null, tableName text, detail text not null, suggestion text, "
+            "created timestamp default current_timestamp, primary key(sql, detail))",
+            tableName);
+        if (int rc = Query(db, sql, {}, nullptr); rc != SQLITE_OK) {
+            LOG_WARN("query advisor: cannot create {} ({}); advice is kept in memory only", tableName, sqlite3_errstr(rc));
+            persist = false;
+            return;
+        }
+        tableReady = true;
+    }
+    auto sql = fmt::format("insert or ignore into {}(sql, finding, tableName, detail, suggestion) values(?, ?, ?, ?, ?)", tableName);
+    for (; nPersisted < advice.size(); nPersisted++) {
+        auto &a = advice[nPersisted];
+        if (int rc = Query(db, sql, {a.sql, FindingName(a.finding), a.table, a.detail, a.suggestion}, nullptr); rc != SQLITE_OK) {
+            LOG_WARN("query advisor: cannot write to {} ({})", tableName, sqlite3_errstr(rc));
+            return;  // retried on the next flush
+        }
+    }
+}
+
+std::vector<wpSQLQueryAdvisor::Advice> wpSQLQueryAdvisor::GetAdvice() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return advice;
+}
+
+std::vector<std::string> wpSQLQueryAdvisor::GetSuggestedIndexes() {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<std::string> list;
+    for (auto &a : advice) {
+        if (!a.suggestion.empty()) AddUnique(list, a.suggestion);
+    }
+    return list;
+}
+
+void wpSQLQueryAdvisor::Reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    Persist();
+    seen.clear();
+    advice.clear();
+    nPersisted = 0;
+}
@@ -0,0 +1,35 @@
+#include <cstring>
+#include <string>
+#include <boost/locale.hpp>
+#include "wpSQLStringArena.h"
+
+std::string_view wpSQLStringArena::Store(std::string_view s) {
+    if (s.empty()) return {};
+    if (s.size() > chunkSize / 4) {  // large values get their own block so they don't waste a chunk tail
+        chunks.push_back(std::make_unique<char[]>(s.size()));
+        bytes += s.size();
+        memcpy(chunks.back().get(), s.data(), s.size());
+        return {chunks.back().get(), s.size()};
+    }
+    if (s.size() > left) {
+        chunks.push_back(std::make_unique<char[]>(chunkSize));
+        bytes += chunkSize;
+        cursor = chunks.back().get();
+        left = chunkSize;
+    }
+    memcpy(cursor, s.data(), s.size());
+    std::string_view stored(cursor, s.size());
+    cursor += s.size();
+    left -= s.size();
+    return stored;
+}
+
+// converts once per distinct value, the same way Get<std::string> does, so both return the same text
+std::string_view wpSQLStringArena::Intern(std::string_view text) {
+    if (auto it = table.find(text); it != table.end()) return it->second;
+    auto converted = boost::locale::conv::utf_to_utf<char>(text.data(), text.data() + text.size());
+    auto value = Store(converted);
+    auto key = converted == text ? value : Store(text);  // invalid utf-8 is looked up by its raw bytes
+    table.emplace(key, value);
+    return value;
+}
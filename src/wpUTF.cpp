@@ -0,0 +1,101 @@
+#include <boost/locale/utf.hpp>
+#include "wpUTF.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define WPUTF_SSE2 1
+#endif
+
+namespace {
+    using Utf8 = boost::locale::utf::utf_traits<char>;
+    using Wide = boost::locale::utf::utf_traits<wchar_t>;
+
+    inline bool Invalid(boost::locale::utf::code_point c) { return c == boost::locale::utf::illegal || c == boost::locale::utf::incomplete; }
+
+#if defined(WPUTF_SSE2)
+    // 16 ascii bytes at p widened into d; false when any of them is not ascii
+    inline bool WidenAscii(const char *p, wchar_t *d) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        if (_mm_movemask_epi8(v) != 0) return false;
+        const __m128i zero = _mm_setzero_si128();
+        __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+        auto out = reinterpret_cast<__m128i *>(d);
+        if constexpr (sizeof(wchar_t) == 4) {
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+        } else {
+            _mm_storeu_si128(out, lo);
+            _mm_storeu_si128(out + 1, hi);
+        }
+        return true;
+    }
+
+    // 16 wide chars at p narrowed into d; false when any of them is not ascii
+    inline bool NarrowAscii(const wchar_t *p, char *d) {
+        auto in = reinterpret_cast<const __m128i *>(p);
+        __m128i packed;
+        if constexpr (sizeof(wchar_t) == 4) {
+            __m128i a = _mm_loadu_si128(in), b = _mm_loadu_si128(in + 1), c = _mm_loadu_si128(in + 2), e = _mm_loadu_si128(in + 3);
+            __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, e)), _mm_set1_epi32(~0x7F));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xFFFF) return false;
+            packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, e));
+        } else {
+            __m128i a = _mm_loadu_si128(in), b = _mm_loadu_si128(in + 1);
+            __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(~0x7F));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF) return false;
+            packed = _mm_packus_epi16(a, b);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d), packed);
+        return true;
+    }
+#endif
+}  // namespace
+
+void wpUTF::AppendUTF8(std::wstring_view in, std::string &out) {
+    constexpr size_t maxBytes = sizeof(wchar_t) == 4 ? 4 : 3;  // per code unit
+    out.resize_and_overwrite(out.size() + in.size() * maxBytes, [start = out.size(), in](char *buffer, size_t) {
+        char *d = buffer + start;
+        const wchar_t *p = in.data(), *end = p + in.size();
+        while (p < end) {
+#if defined(WPUTF_SSE2)
+            while (end - p >= 16 && NarrowAscii(p, d)) {
+                p += 16;
+                d += 16;
+            }
+            if (p == end) break;
+#endif
+            if (static_cast<uint32_t>(*p) < 0x80) {
+                *d++ = static_cast<char>(*p++);
+                continue;
+            }
+            auto c = Wide::decode(p, end);
+            if (!Invalid(c)) d = Utf8::encode(c, d);
+        }
+        return static_cast<size_t>(d - buffer);
+    });
+}
+
+void wpUTF::AppendWide(std::string_view in, std::wstring &out) {
+    out.resize_and_overwrite(out.size() + in.size(), [start = out.size(), in](wchar_t *buffer, size_t) {  // never more code units than bytes
+        wchar_t *d = buffer + start;
+        const char *p = in.data(), *end = p + in.size();
+        while (p < end) {
+#if defined(WPUTF_SSE2)
+            while (end - p >= 16 && WidenAscii(p, d)) {
+                p += 16;
+                d += 16;
+            }
+            if (p == end) break;
+#endif
+            if (static_cast<unsigned char>(*p) < 0x80) {
+                *d++ = static_cast<wchar_t>(*p++);
+                continue;
+            }
+            auto c = Utf8::decode(p, end);
+            if (!Invalid(c)) d = Wide::encode(c, d);
+        }
+        return static_cast<size_t>(d - buffer);
+    });
+}